@@ -1,8 +1,12 @@
 #pragma once
 
 #include <lenny/gui/Application.h>
+#include <lenny/gui/MeshCache.h>
 #include <lenny/gui/Model.h>
+#include <lenny/gui/ModelLoader.h>
+#include <lenny/gui/PickingIndex.h>
 #include <lenny/gui/Plot.h>
+#include <lenny/gui/Polyline.h>
 
 namespace lenny {
 
@@ -24,17 +28,21 @@ public:
     void mouseButtonCallback(double xPos, double yPos, Ray ray, int button, int action);
     void fileDropCallback(int count, const char** fileNames);
 
+    //--- Helpers
+    void rebuildPickingIndex();  //Handles are indices into `models`
+
 public:
     int consoleIter = 0;
     Eigen::Vector4d rendererColor = Eigen::Vector4d(0.75, 0.75, 0.75, 1.0);
     bool showRenderings = false;
     bool showMaterials = true;
 
+    //Loaded in the background, with simplified versions for far away views
     struct Model {
         Model(const std::string& filePath, const Eigen::Vector3d& position, const Eigen::QuaternionD& orientation, const double& scale)
-            : mesh(filePath), position(position), orientation(orientation), scale(scale * Eigen::Vector3d::Ones()) {}
+            : mesh(gui::ModelLoader::load(filePath, true)), position(position), orientation(orientation), scale(scale * Eigen::Vector3d::Ones()) {}
 
-        gui::Model mesh;
+        gui::ModelLoader::Handle mesh;
         Eigen::Vector3d position;
         Eigen::QuaternionD orientation;
         Eigen::Vector3d scale;
@@ -48,6 +56,28 @@ public:
         Model(LENNY_GUI_TESTAPP_FOLDER "/config/widowx/Base.stl", Eigen::Vector3d(0.5, 0.5, 0.0), Eigen::QuaternionD(tools::utils::rotX(-PI / 2.0)), 0.003),
         Model(LENNY_GUI_TESTAPP_FOLDER "/config/spot/Body.dae", Eigen::Vector3d(1.0, 0.5, 0.0), Eigen::QuaternionD::Identity(), 1.0)};
     Model* selectedModel = nullptr;
+    gui::PickingIndex pickingIndex;
+    uint numberOfIndexedModels = 0;  //Models which were ready when the picking index was built
+
+    struct Benchmark {
+        bool enabled = false;
+        int gridSize = 10;     //Number of copies along each axis
+        double spacing = 0.5;  //Distance between copies
+        uint modelIndex = 2;   //Heaviest model in the list
+        gui::MeshCache::CodecBenchmark codec;  //Of the last run
+    } benchmark;
+
+    struct RangeSensor {
+        bool enabled = false;
+        Eigen::Vector3d position = Eigen::Vector3d(0.0, 1.0, 1.5);
+        int horizontalRays = 720;
+        int verticalRays = 32;
+        double verticalRange = PI / 4.0;  //Symmetric around the horizontal plane
+        mutable double castTime = 0.0;     //Of the last scan, in seconds
+    } rangeSensor;
+
+    gui::Polyline trajectory;  //Resident on the GPU, extended by the process
+    static inline size_t maxTrajectoryPoints = 2000;
 
     float data_x = 0.f;
     gui::Plot<Eigen::Vector3d> plot = gui::Plot<Eigen::Vector3d>("Plot", "x-Axis", "y-Axis", 1000);
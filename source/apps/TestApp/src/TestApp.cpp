@@ -4,6 +4,7 @@
 #include <lenny/gui/ImGui.h>
 #include <lenny/gui/Renderer.h>
 #include <lenny/tools/Logger.h>
+#include <lenny/tools/Timer.h>
 
 namespace lenny {
 
@@ -20,21 +21,29 @@ TestApp::TestApp() : gui::Application("TestApp") {
         mouseButtonCallback(xPos, yPos, ray, button, action);
     };
     scenes.back()->f_fileDropCallback = [&](int count, const char** fileNames) -> void { fileDropCallback(count, fileNames); };
+    scenes.back()->usePicking = true;
 
     //Add plot lines
     plot.addLineSpec({"x", [](const Eigen::Vector3d& d) { return (float)d.x(); }});
     plot.addLineSpec({"y", [](const Eigen::Vector3d& d) { return (float)d.y(); }});
     plot.addLineSpec({"z", [](const Eigen::Vector3d& d) { return (float)d.z(); }});
+
+    rebuildPickingIndex();
 }
 
 void TestApp::restart() {
     consoleIter = 0;
     data_x = 0.f;
+    trajectory.clear();
 }
 
 void TestApp::process() {
     LENNY_LOG_INFO("Test: %d", consoleIter++);
     plot.addData(data_x, Eigen::Vector3d::Random());
+    //Keep the most recent points, dropping half of them at once such that the rest is only uploaded again now and then
+    if (trajectory.getNumberOfPoints() >= maxTrajectoryPoints)
+        trajectory.removeFront(maxTrajectoryPoints / 2);
+    trajectory.append(Eigen::Vector3d(std::cos(data_x), 1.0 + 0.25 * std::sin(3.0 * data_x), std::sin(data_x)));
     data_x += (float)getDt();
 }
 
@@ -89,14 +98,74 @@ void TestApp::drawScene() const {
             static const double radius = tools::utils::getRandomNumberInRange({0.1, 0.1});
             gui::Renderer::I->drawSector(center, orientation, radius, std::pair<double, double>{0.0, 1.5 * PI}, rendererColor);
         }
+
+        trajectory.draw(0.005, rendererColor, false);
+
+        {
+            //Swirl next to the models, drawn unlit
+            static const Eigen::Vector3d center(0.0, 0.01, -2.0);
+            for (int i = -10; i <= 10; i++) {
+                for (int j = -10; j <= 10; j++) {
+                    const Eigen::Vector3d position = center + 0.05 * Eigen::Vector3d(i, 0.0, j);
+                    const Eigen::Vector3d velocity = 0.01 * Eigen::Vector3d(-j, 0.0, i);
+                    gui::Renderer::drawDebugLine(position, position + velocity, Eigen::Vector4d(0.0, 0.0, 0.75, 1.0));
+                    gui::Renderer::drawDebugPoint(position, Eigen::Vector4d(0.75, 0.0, 0.0, 1.0));
+                }
+            }
+            gui::Renderer::drawDebugBox(center, Eigen::QuaternionD::Identity(), Eigen::Vector3d(1.0, 0.1, 1.0), Eigen::Vector4d(0.0, 0.0, 0.0, 1.0));
+        }
+    }
+
+    //--- Range sensor, scanning the models around it
+    if (rangeSensor.enabled) {
+        std::vector<Ray> rays;
+        rays.reserve(rangeSensor.horizontalRays * rangeSensor.verticalRays);
+        for (int i = 0; i < rangeSensor.horizontalRays; i++) {
+            const double yaw = 2.0 * PI * i / rangeSensor.horizontalRays;
+            for (int j = 0; j < rangeSensor.verticalRays; j++) {
+                const double pitch = rangeSensor.verticalRange * ((j + 0.5) / rangeSensor.verticalRays - 0.5);
+                rays.push_back({rangeSensor.position, Eigen::Vector3d(std::cos(pitch) * std::sin(yaw), std::sin(pitch), std::cos(pitch) * std::cos(yaw))});
+            }
+        }
+
+        const tools::Timer timer;
+        const auto hits = pickingIndex.castRays(rays);
+        rangeSensor.castTime = timer.time();
+
+        gui::Renderer::drawDebugPoint(rangeSensor.position, Eigen::Vector4d(0.0, 0.0, 0.0, 1.0));
+        for (const auto& hit : hits)
+            if (hit.has_value())
+                gui::Renderer::drawDebugPoint(hit->info.hitPoint, Eigen::Vector4d(0.75, 0.0, 0.0, 1.0));
     }
 
     //--- Models
     std::optional<Eigen::Vector3d> modelColor = std::nullopt;
     if (!showMaterials)
         modelColor = rendererColor.segment(0, 3);
-    for (const Model& model : models)
-        model.mesh.draw(model.position, model.orientation, model.scale, modelColor, rendererColor[3]);
+    //Tag every model with its index plus one, and tint the one under the cursor
+    const uint hoveredID = scenes.front()->getHoveredID();
+    for (uint i = 0; i < models.size(); i++) {
+        gui::Model::objectID = i + 1;
+        const std::optional<Eigen::Vector3d> color = (i + 1 == hoveredID) ? std::optional<Eigen::Vector3d>(Eigen::Vector3d(1.0, 0.8, 0.2)) : modelColor;
+        models[i].mesh.draw(models[i].position, models[i].orientation, models[i].scale, color, rendererColor[3]);
+    }
+    gui::Model::objectID = 0;
+
+    //--- Cursor, marked on the surface below it
+    if (const std::optional<Eigen::Vector3d> cursorPoint = scenes.front()->getCursorPoint())
+        gui::Renderer::drawDebugPoint(cursorPoint.value(), Eigen::Vector4d(1.0, 0.5, 0.0, 1.0));
+
+    //--- Benchmark
+    if (benchmark.enabled && benchmark.modelIndex < models.size()) {
+        const Model& model = models[benchmark.modelIndex];
+        const double offset = 0.5 * (benchmark.gridSize - 1) * benchmark.spacing;
+        for (int i = 0; i < benchmark.gridSize; i++) {
+            for (int j = 0; j < benchmark.gridSize; j++) {
+                const Eigen::Vector3d position(i * benchmark.spacing - offset, model.position.y(), j * benchmark.spacing - offset + 2.0);
+                model.mesh.draw(position, model.orientation, model.scale, modelColor, rendererColor[3]);
+            }
+        }
+    }
 }
 
 void TestApp::drawGui() {
@@ -106,6 +175,13 @@ void TestApp::drawGui() {
     ImGui::ColorPicker4("Renderer Color", rendererColor);
     ImGui::Checkbox("Show Materials", &showMaterials);
 
+    //Models become pickable once they are loaded
+    const uint numberOfReadyModels = (uint)std::count_if(models.begin(), models.end(), [](const Model& model) -> bool { return model.mesh.isReady(); });
+    if (numberOfReadyModels != numberOfIndexedModels)
+        rebuildPickingIndex();
+    if (gui::ModelLoader::getNumberOfPendingLoads() > 0)
+        ImGui::Text("Loading %u models...", gui::ModelLoader::getNumberOfPendingLoads());
+
     if (selectedModel) {
         static float threshold = 0.8f;
         static float targetError = 0.01;
@@ -113,11 +189,54 @@ void TestApp::drawGui() {
         ImGui::SliderFloat("Threshold", &threshold, 0.f, 1.f);
         ImGui::SliderFloat("Target Error", &targetError, 0.f, 1.f);
         ImGui::Checkbox("Save To File", &saveToFile);
-        if (ImGui::Button("Simplify"))
-            selectedModel->mesh.simplify(threshold, targetError, saveToFile);
+        if (ImGui::Button("Simplify")) {
+            //Loaded models are shared through the asset cache, so only this one switches to a simplified copy
+            std::shared_ptr<gui::Model> simplified = std::make_shared<gui::Model>(*selectedModel->mesh.get());
+            simplified->simplify(threshold, targetError, saveToFile);
+            selectedModel->mesh = gui::ModelLoader::Handle(simplified);
+            rebuildPickingIndex();
+        }
 
         if (ImGui::Button("Export as OBJ"))
-            selectedModel->mesh.exportAsOBJ();
+            selectedModel->mesh.get()->exportAsOBJ();
+    }
+
+    //--- Benchmark
+    if (ImGui::TreeNode("Benchmark")) {
+        ImGui::Checkbox("Enabled", &benchmark.enabled);
+        ImGui::SliderInt("Grid Size", &benchmark.gridSize, 1, 30);
+        ImGui::SliderDouble("Spacing", &benchmark.spacing, 0.1, 2.0);
+        ImGui::Checkbox("Precomputed Normal Matrix", &gui::Model::usePrecomputedNormalMatrix);
+
+        const gui::Model::Statistics& statistics = getModelStatistics();
+        const double framerate = (double)ImGui::GetIO().Framerate;
+        ImGui::Text("Frame time: %.2f ms", 1000.0 / framerate);
+        ImGui::Text("Vertices per frame: %.2f M", 1e-6 * (double)statistics.vertices);
+        ImGui::Text("Vertex throughput: %.1f M/s", 1e-6 * (double)statistics.vertices * framerate);
+
+        //Compression of the meshes in the mesh cache
+        if (ImGui::Button("Benchmark Mesh Codec") && benchmark.modelIndex < models.size() && models[benchmark.modelIndex].mesh.isReady())
+            benchmark.codec = gui::MeshCache::benchmarkCodec(*models[benchmark.modelIndex].mesh.get());
+        if (benchmark.codec.encodedBytes > 0) {
+            ImGui::Text("Size: %.2f MB -> %.2f MB (%.1fx)", 1e-6 * (double)benchmark.codec.rawBytes, 1e-6 * (double)benchmark.codec.encodedBytes,
+                        (double)benchmark.codec.rawBytes / (double)benchmark.codec.encodedBytes);
+            ImGui::Text("Encoding: %.1f MB/s", 1e-6 * (double)benchmark.codec.rawBytes / benchmark.codec.encodeSeconds);
+            ImGui::Text("Decoding: %.1f MB/s", 1e-6 * (double)benchmark.codec.rawBytes / benchmark.codec.decodeSeconds);
+        }
+
+        ImGui::TreePop();
+    }
+
+    //--- Range sensor
+    if (ImGui::TreeNode("Range Sensor")) {
+        ImGui::Checkbox("Enabled", &rangeSensor.enabled);
+        ImGui::InputDouble("x", &rangeSensor.position.x());
+        ImGui::InputDouble("y", &rangeSensor.position.y());
+        ImGui::InputDouble("z", &rangeSensor.position.z());
+        ImGui::SliderInt("Horizontal Rays", &rangeSensor.horizontalRays, 1, 3600);
+        ImGui::SliderInt("Vertical Rays", &rangeSensor.verticalRays, 1, 128);
+        ImGui::Text("Cast time: %.2f ms (%d rays)", 1000.0 * rangeSensor.castTime, rangeSensor.horizontalRays * rangeSensor.verticalRays);
+        ImGui::TreePop();
     }
 
     //--- ImPlot
@@ -130,25 +249,34 @@ void TestApp::drawGui() {
 }
 
 void TestApp::drawGuizmo() {
-    if (selectedModel)
+    if (selectedModel) {
         gui::Guizmo::useWidget(selectedModel->position, selectedModel->orientation, selectedModel->scale);
+        pickingIndex.update(selectedModel - models.data(), selectedModel->position, selectedModel->orientation, selectedModel->scale);
+    }
 }
 
 void TestApp::mouseButtonCallback(double xPos, double yPos, Ray ray, int button, int action) {
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-        selectedModel = nullptr;
-        for (Model& model : models) {
-            const auto hitInfo = model.mesh.hitByRay(model.position, model.orientation, model.scale, ray);
-            if (hitInfo.has_value()) {
-                selectedModel = &model;
-                break;
-            }
-        }
+        const auto hit = pickingIndex.hitByRay(ray);
+        selectedModel = hit.has_value() ? &models.at(hit->handle) : nullptr;
     }
 }
 
 void TestApp::fileDropCallback(int count, const char** fileNames) {
+    //Adding a model might move the others, so the index needs to reference them again
     models.emplace_back(fileNames[count - 1], Eigen::Vector3d::Zero(), Eigen::QuaternionD::Identity(), 1.0);
+    selectedModel = nullptr;
+    rebuildPickingIndex();
+}
+
+void TestApp::rebuildPickingIndex() {
+    //Models which are still loading have no meshes yet, so the index skips them
+    pickingIndex.clear();
+    numberOfIndexedModels = 0;
+    for (const Model& model : models) {
+        pickingIndex.add(*model.mesh.get(), model.position, model.orientation, model.scale);
+        numberOfIndexedModels += model.mesh.isReady() ? 1 : 0;
+    }
 }
 
 }  // namespace lenny
@@ -0,0 +1,13 @@
+#version 460 core
+
+in vec4 Color;
+
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out uint FragID;
+
+//Unlit, the color is used as is
+void main()
+{
+    FragColor = Color;
+    FragID = 0u;
+}
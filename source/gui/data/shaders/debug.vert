@@ -0,0 +1,17 @@
+#version 460 core
+
+#include "scene.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor;
+
+out vec4 Color;
+
+uniform float pointSize;
+
+void main()
+{
+    Color = aColor;
+    gl_PointSize = pointSize;
+    gl_Position = cameraProjection * cameraView * vec4(aPos, 1.0);
+}
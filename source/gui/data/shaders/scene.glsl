@@ -0,0 +1,11 @@
+//Camera and light data, uploaded once per scene (see Shaders::SceneData)
+layout (std140, binding = 0) uniform SceneData
+{
+    mat4 cameraProjection;
+    mat4 cameraView;
+    vec4 cameraPosition;
+    vec4 lightPosition;
+    vec4 lightColor;
+    vec4 lightGlow;
+    vec4 lightStrength; //x: ambient, y: diffuse, z: specular
+};
@@ -1,5 +1,7 @@
 #version 460 core
 
+#include "scene.glsl"
+
 struct Material
 {
     vec3 ambient;
@@ -7,58 +9,44 @@ struct Material
     vec3 specular;
 };
 
-struct Strength
-{
-    float ambient;
-    float diffuse;
-    float specular;
-};
-
 in vec3 Normal;
 in vec3 FragPos;
 in vec2 TexCoords;
+in vec4 Color;
 
-out vec4 FragColor;
-
-uniform vec3 cameraPosition;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out uint FragID;  //Only stored if the scene renders its ID buffer
 
-uniform vec3 lightPosition;
-uniform vec3 lightColor;
-uniform vec3 lightGlow;
+uniform uint objectID;
 
-uniform vec3 objectColor;
-uniform float objectAlpha;
-
-uniform Strength strength;
-
-uniform bool useMaterial;
-uniform Material material;
-
-uniform bool useTexture;
+#if defined(TEXTURE)
 uniform sampler2D texture_diffuse;
+#elif defined(MATERIAL)
+uniform Material material;
+#endif
 
 vec3 getLightDir(){
-    return normalize((cameraPosition + lightPosition) - FragPos);
+    return normalize((cameraPosition.xyz + lightPosition.xyz) - FragPos);
 }
 
 vec3 computeAmbientComponent(){
-    return strength.ambient * lightColor;
+    return lightStrength.x * lightColor.rgb;
 }
 
 vec3 computeDiffuseComponent(){
     vec3 norm = normalize(Normal);
     vec3 lightDir = getLightDir();
     float diff = max(dot(norm, lightDir), 0.0);
-    return strength.diffuse * diff * lightColor;
+    return lightStrength.y * diff * lightColor.rgb;
 }
 
 vec3 computeSpecularComponent(){
-    vec3 viewDir = normalize(cameraPosition - FragPos);
+    vec3 viewDir = normalize(cameraPosition.xyz - FragPos);
     vec3 lightDir = getLightDir();
     vec3 norm = normalize(Normal);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-    return strength.specular * spec * lightColor;
+    return lightStrength.z * spec * lightColor.rgb;
 }
 
 vec3 computeBasicShading(){
@@ -76,24 +64,31 @@ vec3 computeGlowDirection(vec3 direction, vec3 color, vec3 normal) {
 
 void main()
 {
-    vec3 viewDir = normalize(cameraPosition - FragPos);
+    vec3 viewDir = normalize(cameraPosition.xyz - FragPos);
     vec3 norm = normalize(Normal);
 
-    if (useTexture == true){
-        vec3 color = computeBasicShading();
-        color += computeGlowDirection(-viewDir, lightGlow, norm)* color;
-        FragColor = vec4(color, objectAlpha) * texture(texture_diffuse, TexCoords);
-    }
-    else if (useMaterial == true) {
-        vec3 ambient = material.ambient * computeAmbientComponent();
-        vec3 diffuse = material.diffuse * computeDiffuseComponent();
-        vec3 specular = material.specular * computeSpecularComponent();
-        vec3 color = ambient + diffuse + specular;
-        color += computeGlowDirection(-viewDir, lightGlow, norm)* color;
-        FragColor = vec4(color, objectAlpha);
-    } else {
-        vec3 color = computeBasicShading() * objectColor;
-        color += computeGlowDirection(-viewDir, lightGlow, norm)* color;
-        FragColor = vec4(color, objectAlpha);
-    }
+#if defined(TEXTURE)
+    vec3 color = computeBasicShading();
+    color += computeGlowDirection(-viewDir, lightGlow.rgb, norm)* color;
+#ifdef WORLD_TEXCOORDS
+    //Procedural tiling, one texture repetition per world unit
+    vec2 texCoords = FragPos.xz;
+#else
+    vec2 texCoords = TexCoords;
+#endif
+    FragColor = vec4(color, Color.a) * texture(texture_diffuse, texCoords);
+#elif defined(MATERIAL)
+    vec3 ambient = material.ambient * computeAmbientComponent();
+    vec3 diffuse = material.diffuse * computeDiffuseComponent();
+    vec3 specular = material.specular * computeSpecularComponent();
+    vec3 color = ambient + diffuse + specular;
+    color += computeGlowDirection(-viewDir, lightGlow.rgb, norm)* color;
+    FragColor = vec4(color, Color.a);
+#else
+    vec3 color = computeBasicShading() * Color.rgb;
+    color += computeGlowDirection(-viewDir, lightGlow.rgb, norm)* color;
+    FragColor = vec4(color, Color.a);
+#endif
+
+    FragID = objectID;
 }
@@ -1,21 +1,100 @@
 #version 460 core
 
-layout (location = 0) in vec3 aPos;
+#include "scene.glsl"
+
+layout (location = 0) in vec3 aPos;  //Normalized within the bounds of the mesh if packed
+#ifdef PACKED
+layout (location = 1) in vec2 aNormal;  //Octahedral
+#else
 layout (location = 1) in vec3 aNormal;
+#endif
 layout (location = 2) in vec2 aTexCoords;
+#ifdef INSTANCED
+layout (location = 3) in mat4 aInstancePose;
+layout (location = 7) in mat3 aInstanceNormalMatrix;
+layout (location = 10) in vec4 aInstanceColor;
+#elif defined(TUBE)
+layout (location = 3) in vec3 aSegmentStart;
+layout (location = 4) in vec3 aSegmentEnd;
+#elif defined(JOINT)
+layout (location = 3) in vec3 aJointCenter;
+#endif
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+out vec4 Color;
 
+#ifndef INSTANCED
 uniform mat4 modelPose;
-uniform mat4 cameraView;
-uniform mat4 cameraProjection;
+uniform mat3 normalMatrix;
+
+uniform vec3 objectColor;
+uniform float objectAlpha;
+#endif
+
+#if defined(TUBE) || defined(JOINT)
+uniform float polylineRadius;
+#endif
+
+#ifdef PACKED
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+vec3 decodeOctahedral(vec2 e)
+{
+    //Unfold the lower half of the octahedron
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+#endif
+
+uniform bool usePrecomputedNormalMatrix;
 
 void main()
 {
-    FragPos = vec3(modelPose * vec4(aPos, 1.0));
-    Normal = vec3(transpose(inverse(modelPose)) * vec4(aNormal, 0));
+#ifdef PACKED
+    vec3 position = positionOffset + positionScale * aPos;
+    vec3 normal = decodeOctahedral(aNormal);
+#else
+    vec3 position = aPos;
+    vec3 normal = aNormal;
+#endif
+
+#if defined(INSTANCED)
+    mat4 pose = aInstancePose;
+    mat3 normalPose = aInstanceNormalMatrix;
+    Color = aInstanceColor;
+#elif defined(TUBE)
+    //Map the unit cylinder (along z) onto the segment, with the same perpendiculars as the renderer uses on the CPU
+    vec3 axis = aSegmentEnd - aSegmentStart;
+    vec3 a = length(axis) > 1e-9 ? normalize(axis) : vec3(0.0, 0.0, 1.0);
+    vec3 helper = abs(a.x) < 0.9 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0);
+    vec3 u = normalize(cross(helper, a));
+    vec3 v = cross(a, u);
+    mat4 pose = mat4(vec4(polylineRadius * u, 0.0), vec4(polylineRadius * v, 0.0), vec4(axis, 0.0), vec4(aSegmentStart, 1.0));
+    mat3 normalPose = mat3(u, v, a);
+    Color = vec4(objectColor, objectAlpha);
+#elif defined(JOINT)
+    //The unit sphere spans [-0.5, 0.5]
+    mat4 pose = mat4(2.0 * polylineRadius);
+    pose[3] = vec4(aJointCenter, 1.0);
+    mat3 normalPose = mat3(1.0);
+    Color = vec4(objectColor, objectAlpha);
+#else
+    mat4 pose = modelPose;
+    mat3 normalPose = normalMatrix;
+    Color = vec4(objectColor, objectAlpha);
+#endif
+
+    FragPos = vec3(pose * vec4(position, 1.0));
+    if (usePrecomputedNormalMatrix)
+        Normal = normalPose * normal;
+    else
+        Normal = vec3(transpose(inverse(pose)) * vec4(normal, 0));
     TexCoords = aTexCoords;
 
     gl_Position = cameraProjection * cameraView * vec4(FragPos, 1.0);
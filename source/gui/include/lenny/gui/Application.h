@@ -1,8 +1,10 @@
 #pragma once
 
 #include <GLFW/glfw3.h>
+#include <lenny/gui/Model.h>
 #include <lenny/gui/Process.h>
 #include <lenny/gui/Scene.h>
+#include <lenny/gui/Shader.h>
 
 namespace lenny::gui {
 
@@ -25,6 +27,7 @@ protected:
 
     //--- Helpers
     double getDt() const;
+    const Model::Statistics& getModelStatistics() const;  //Of the previous frame
     std::pair<int, int> getCurrentWindowPosition() const;
     std::pair<int, int> getCurrentWindowSize() const;
     bool saveScreenshotToFile(const std::string& filePath) const;
@@ -62,6 +65,10 @@ private:
 
     //--- Framerate
     double currentFramerate = targetFramerate;  //Framerate of drawing process (not for separate thread)
+
+    //--- Statistics
+    Shader::Statistics shaderStatistics;  //Of the previous frame
+    Model::Statistics modelStatistics;    //Of the previous frame
 };
 
 }  // namespace lenny::gui
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <lenny/gui/Model.h>
+
+#include <map>
+#include <utility>
+
+namespace lenny::gui {
+
+//Models shared by file path, such that every file is imported and uploaded only once. Cached models are immutable, and only used on the main thread
+class AssetCache {
+private:  //Make constructor private, since we want to this to be a purely static class
+    AssetCache() = default;
+    ~AssetCache() = default;
+
+public:
+    using Key = std::pair<std::string, bool>;  //Normalized path, shared by different spellings of the same file, and whether levels of detail are generated
+
+    struct Statistics {
+        long users = 0;        //References outside of the cache
+        size_t cpuBytes = 0;  //Vertices and indices
+        size_t gpuBytes = 0;  //Buffers and textures
+        size_t packingSavings = 0;  //Vertex buffer bytes saved by packed meshes
+    };
+
+    //Owning handle of a cached model, for code which needs a `tools::Model` (e.g. through `Model::f_loadModel`)
+    class Reference : public tools::Model {
+    public:
+        Reference(const std::shared_ptr<const gui::Model> &asset);
+        ~Reference() = default;
+
+        void draw(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation, const Eigen::Vector3d &scale, const std::optional<Eigen::Vector3d> &color,
+                  const double &alpha) const override;
+        std::optional<HitInfo> hitByRay(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation, const Eigen::Vector3d &scale,
+                                        const Ray &ray) const override;
+
+    public:
+        const std::shared_ptr<const gui::Model> asset;
+    };
+
+public:
+    //Loads the file on first use, or finishes loading it right away if the model loader is working on it
+    static std::shared_ptr<const Model> get(const std::string &filePath, const bool &generateLODs = Model::generateLODsOnLoad);
+    static std::shared_ptr<const Model> find(const std::string &filePath, const bool &generateLODs = Model::generateLODsOnLoad);  //Nullptr if not cached, never loads
+    static void add(const std::shared_ptr<const Model> &model, const bool &generateLODs);  //Under its file path (e.g. after loading it in the background), unless cached
+    static Key getKey(const std::string &filePath, const bool &generateLODs);
+    static bool evict(const std::string &filePath);  //With and without levels of detail. Models stay alive as long as they are used, false if the file is not cached
+    static uint evictUnused();                       //Models which are only referenced by the cache
+    static Statistics getStatistics(const std::string &filePath, const bool &generateLODs = Model::generateLODsOnLoad);
+    static void drawGui();
+
+private:
+    static inline std::map<Key, std::shared_ptr<const Model>> assets;
+};
+
+}  // namespace lenny::gui
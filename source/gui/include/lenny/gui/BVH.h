@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace lenny::gui {
+
+//Bounding volume hierarchy over the triangles of a mesh, built with the surface area heuristic and stored as a flat node array
+class BVH {
+public:
+    using Triangle = std::array<glm::vec3, 3>;
+
+    //Two nodes per cache line. Children of inner nodes are stored next to each other
+    struct Node {
+        glm::vec3 min;
+        uint leftOrFirst;  //Left child for inner nodes, first triangle for leaves
+        glm::vec3 max;
+        uint count;  //Triangles of leaves, 0 for inner nodes
+    };
+
+    struct Hit {
+        float t;
+        glm::vec2 barycentric;  //Weights of the second and third vertex
+        uint triangle;          //Index in the triangle list given to the constructor
+    };
+
+public:
+    BVH(const std::vector<Triangle>& triangles);
+    ~BVH() = default;
+
+    //Closest hit with 0 < t < tMax, the direction does not need to be normalized
+    std::optional<Hit> intersect(const glm::vec3& origin, const glm::vec3& direction, const float& tMax = std::numeric_limits<float>::max()) const;
+
+    uint getNumberOfNodes() const;
+
+    //Distance along the ray to the box (0 if the origin is inside), or infinity if it is missed before `tMax`
+    static float intersectBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const float& tMax, const glm::vec3& min, const glm::vec3& max) {
+        const glm::vec3 t0 = (min - origin) * inverseDirection;
+        const glm::vec3 t1 = (max - origin) * inverseDirection;
+        const glm::vec3 tSmall = glm::min(t0, t1), tLarge = glm::max(t0, t1);
+        const float tNear = std::max({tSmall.x, tSmall.y, tSmall.z, 0.f});
+        const float tFar = std::min({tLarge.x, tLarge.y, tLarge.z, tMax});
+        return tNear <= tFar ? tNear : std::numeric_limits<float>::infinity();
+    }
+
+    //Depth first over a flat node array laid out like `Node` (also used by the picking index), visiting the closer child first.
+    //`intersectLeaf(node, tClosest)` tests the content of a leaf and lowers `tClosest` for closer hits. `depth` is the level of the deepest leaf
+    template <typename NODE, typename F_INTERSECT_LEAF>
+    static void traverse(const std::vector<NODE>& nodes, const uint& depth, const glm::vec3& origin, const glm::vec3& inverseDirection, float& tClosest,
+                         const F_INTERSECT_LEAF& intersectLeaf) {
+        //At most one entry per level is pending, only deep trees (e.g. of degenerate meshes) need the heap
+        std::array<uint, 64> localStack;
+        std::vector<uint> heapStack(depth + 1 > localStack.size() ? depth + 1 : 0);
+        uint* stack = heapStack.empty() ? localStack.data() : heapStack.data();
+        uint stackSize = 0;
+        if (!nodes.empty() && intersectBox(origin, inverseDirection, tClosest, nodes[0].min, nodes[0].max) < std::numeric_limits<float>::infinity())
+            stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const NODE& node = nodes[stack[--stackSize]];
+            if (intersectBox(origin, inverseDirection, tClosest, node.min, node.max) == std::numeric_limits<float>::infinity())
+                continue;  //A closer hit was found in the meantime
+
+            if (node.count > 0) {
+                intersectLeaf(node, tClosest);
+                continue;
+            }
+
+            const uint left = node.leftOrFirst, right = node.leftOrFirst + 1;
+            const float tLeft = intersectBox(origin, inverseDirection, tClosest, nodes[left].min, nodes[left].max);
+            const float tRight = intersectBox(origin, inverseDirection, tClosest, nodes[right].min, nodes[right].max);
+            const bool leftIsCloser = tLeft <= tRight;
+            const float tNear = leftIsCloser ? tLeft : tRight, tFar = leftIsCloser ? tRight : tLeft;
+            if (tFar < std::numeric_limits<float>::infinity())
+                stack[stackSize++] = leftIsCloser ? right : left;
+            if (tNear < std::numeric_limits<float>::infinity())
+                stack[stackSize++] = leftIsCloser ? left : right;
+        }
+    }
+
+private:
+    void updateBounds(const uint& nodeIndex);
+    void subdivide(const uint& nodeIndex, const uint& level);
+    void intersectLeaf(const Node& node, const glm::vec3& origin, const glm::vec3& direction, float& tClosest, std::optional<Hit>& hit) const;
+
+private:
+    //Triangles are tested in packets of this size, written such that the compiler can vectorize them
+    static constexpr uint packetSize = 8;
+    enum COMPONENT { V0_X, V0_Y, V0_Z, E1_X, E1_Y, E1_Z, E2_X, E2_Y, E2_Z, NUMBER_OF_COMPONENTS };
+
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;  //Reordered during the build, such that every leaf references a consecutive range
+    std::array<std::vector<float>, NUMBER_OF_COMPONENTS> triangleData;  //First vertex and edges of the reordered triangles (structure of arrays, padded by a packet)
+    std::vector<uint> triangleIndices;  //Original index per reordered triangle
+    uint depth = 0;                     //Level of the deepest leaf, which bounds the traversal stack
+};
+
+}  // namespace lenny::gui
@@ -16,7 +16,7 @@ public:
     glm::mat4 getViewMatrix() const;
     glm::mat4 getProjectionMatrix() const;
     Ray getRayFromScreenCoordinates(double xPos, double yPos, const glm::vec4& viewportParams) const;
-    Eigen::Vector3d getGlobalPointFromScreenCoordinates(const Eigen::Vector3d& globalTargetPoint, double xPos, double yPos, const glm::vec4& viewportParams) const;
+    Eigen::Vector3d getGlobalPointFromScreenCoordinates(const Eigen::Vector3d& globalTargetPoint, double xPos, double yPos, const glm::vec4& viewportParams) const;  //On a camera facing plane, see `Scene::getCursorPoint` for surface points
 
     //--- Set
     void setAspectRatio(double aspectRatio);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <lenny/gui/Model.h>
+
+#include <array>
+
+namespace lenny::gui {
+
+//Camera frustum of a scene, used to skip meshes and instances which are not visible
+class Frustum {
+public:
+    struct Statistics {
+        unsigned long long visible = 0;  //Meshes and instances which passed the test
+        unsigned long long culled = 0;
+    };
+
+public:
+    Frustum() = default;  //Contains everything
+    Frustum(const glm::mat4& projectionView);
+    ~Frustum() = default;
+
+    //--- Tests (update the statistics)
+    bool isVisible(const Model::Mesh::Bounds& bounds, const glm::mat4& pose) const;
+    void cull(const Model::Mesh::Bounds& bounds, const std::vector<Model::Instance>& instances, std::vector<Model::Instance>& visibleInstances) const;
+
+private:
+    bool test(const Model::Mesh::Bounds& bounds, const glm::mat4& pose) const;
+
+public:
+    inline static const Frustum* current = nullptr;  //Set by the scene while it is drawn
+    inline static bool enabled = true;
+
+    mutable Statistics statistics;
+
+private:
+    std::array<glm::vec4, 6> planes;  //Normals point inwards and are normalized
+    bool isEmpty = true;
+};
+
+}  // namespace lenny::gui
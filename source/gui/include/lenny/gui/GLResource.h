@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace lenny::gui {
+
+class GLResources {
+private:  //Make constructor private, since we want to this to be a purely static class
+    GLResources() = default;
+    ~GLResources() = default;
+
+public:
+    enum TYPE { BUFFER, VERTEX_ARRAY, TEXTURE, FRAMEBUFFER, RENDERBUFFER, PROGRAM, NUMBER_OF_TYPES };
+    struct Usage {
+        long long count;  //Live objects
+        long long bytes;  //Size of their data stores, as far as it is known
+    };
+
+public:
+    static unsigned int generate(const TYPE& type);
+    static void destroy(const TYPE& type, const unsigned int& id);
+    static void drawGui();
+
+public:
+    static std::array<Usage, NUMBER_OF_TYPES> usage;
+    static bool contextIsAlive;  //Objects outliving the context are only removed from the accounting
+};
+
+//--- Move-only owner of a single GL object, which is deleted together with its owner
+template <GLResources::TYPE type>
+class GLResource {
+public:
+    GLResource() = default;  //Empty, use `create` to generate an object
+    ~GLResource() {
+        reset();
+    }
+
+    GLResource(const GLResource&) = delete;
+    GLResource& operator=(const GLResource&) = delete;
+    GLResource(GLResource&& other) noexcept : id(std::exchange(other.id, 0)), bytes(std::exchange(other.bytes, 0)) {}
+    GLResource& operator=(GLResource&& other) noexcept {
+        if (this != &other) {
+            reset();
+            id = std::exchange(other.id, 0);
+            bytes = std::exchange(other.bytes, 0);
+        }
+        return *this;
+    }
+
+    static GLResource create() {
+        GLResource resource;
+        resource.id = GLResources::generate(type);
+        return resource;
+    }
+
+    void reset() {
+        if (id == 0)
+            return;
+        GLResources::destroy(type, id);
+        GLResources::usage[type].bytes -= (long long)bytes;
+        id = 0;
+        bytes = 0;
+    }
+
+    //Size of the data store, only used for accounting
+    void setBytes(const size_t& bytes) {
+        GLResources::usage[type].bytes += (long long)bytes - (long long)this->bytes;
+        this->bytes = bytes;
+    }
+
+    size_t getBytes() const {
+        return bytes;
+    }
+
+    unsigned int getID() const {
+        return id;
+    }
+
+    explicit operator bool() const {
+        return id != 0;
+    }
+
+private:
+    unsigned int id = 0;
+    size_t bytes = 0;
+};
+
+using GLBuffer = GLResource<GLResources::BUFFER>;
+using GLVertexArray = GLResource<GLResources::VERTEX_ARRAY>;
+using GLTexture = GLResource<GLResources::TEXTURE>;
+using GLFramebuffer = GLResource<GLResources::FRAMEBUFFER>;
+using GLRenderbuffer = GLResource<GLResources::RENDERBUFFER>;
+using GLProgram = GLResource<GLResources::PROGRAM>;
+
+}  // namespace lenny::gui
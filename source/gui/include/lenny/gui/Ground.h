@@ -6,6 +6,9 @@
 namespace lenny::gui {
 
 class Ground {
+public:
+    enum MODE { TILED, PROCEDURAL };
+
 public:
     Ground(int size = 50);
     ~Ground() = default;
@@ -21,13 +24,20 @@ public:
 
     void sync(const Ground& otherGround);
 
+private:
+    void updateTiledModel();
+    static Model createQuad(const Model& tile);
+
 public:
     double alpha = 1.0;
+    MODE mode = PROCEDURAL;
 
 private:
     int size; //Set by constructor
     const Model tile = Model(LENNY_GUI_OPENGL_FOLDER "/data/ground/ground.obj");
-    Model model = Model(tile.meshes);
+    Model model = Model(tile.meshes);  //Tiled mode: one copy of the tile per unit square, rebuilt on resize
+    int tiledSize = -1;                //Size the tiled model has been built for
+    const Model quad = createQuad(tile);  //Procedural mode: a single tile scaled to the ground size, tiled in the fragment shader
 };
 
 }  // namespace lenny::gui
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <lenny/gui/Model.h>
+
+namespace lenny::gui {
+
+//Preprocessed content of model files, stored in a binary file per source file such that Assimp only runs once
+class MeshCache {
+private:  //Make constructor private, since we want to this to be a purely static class
+    MeshCache() = default;
+    ~MeshCache() = default;
+
+public:
+    //Sizes and timings of the vertex and index codec, raw sizes count vertices and indices as stored in meshes
+    struct CodecBenchmark {
+        size_t rawBytes = 0, encodedBytes = 0;
+        double encodeSeconds = 0.0, decodeSeconds = 0.0;
+    };
+
+public:
+    //Textures are listed by file path, and still need to be decoded. Stale or unreadable entries are treated as misses
+    static std::optional<Model::Data> read(const std::string &filePath, const uint &loadFlags);
+    static void write(const std::string &filePath, const uint &loadFlags, const Model::Data &data);
+    static CodecBenchmark benchmarkCodec(const Model &model);  //Encodes and decodes all meshes in memory
+
+public:
+    static inline bool enabled = true;
+    static inline bool compress = true;  //Stores new entries with the meshoptimizer codecs, both kinds of entries can be read
+    static inline std::string folder = LENNY_PROJECT_FOLDER "/cache";
+
+private:
+    static std::string getCacheFilePath(const std::string &filePath);
+};
+
+}  // namespace lenny::gui
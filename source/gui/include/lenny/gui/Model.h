@@ -1,13 +1,45 @@
 #pragma once
 
+#include <lenny/gui/GLResource.h>
 #include <lenny/tools/Model.h>
 
+#include <array>
 #include <glm/glm.hpp>
+#include <span>
+#include <utility>
 
 namespace lenny::gui {
 
+class BVH;
+
 class Model : public tools::Model {
 public:
+    struct Instance {
+        Instance() = default;
+        Instance(const glm::mat4 &pose, const glm::vec4 &color);
+
+        glm::mat4 pose = glm::mat4(1.f);
+        glm::mat3 normalMatrix = glm::mat3(1.f);  //Precomputed from pose
+        glm::vec4 color = glm::vec4(1.f);
+    };
+
+    //Camera of the scene which is drawn, used to select levels of detail
+    struct View {
+        glm::vec3 position;
+        float pixelsPerUnit;  //Projected size of a unit length at unit distance
+    };
+
+    struct Statistics {
+        unsigned long long drawCalls = 0;
+        unsigned long long vertices = 0;  //Vertices submitted, counting every instance
+    };
+
+    //Of all live meshes, including those which are not cached or drawn
+    struct PackingStatistics {
+        long long meshes = 0;      //With packed vertices
+        long long savedBytes = 0;  //Vertex buffer bytes saved by them
+    };
+
     class Mesh {
     public:
         struct Vertex {
@@ -20,56 +52,192 @@ public:
             }
         };
 
+        //Compact layout of the vertex buffer (16 instead of 32 bytes), decoded by the vertex shader
+        struct PackedVertex {
+            std::array<uint16_t, 4> position;  //Normalized within the bounds of the mesh (the last one pads to 8 bytes)
+            std::array<int16_t, 2> normal;     //Octahedral, signed normalized
+            std::array<uint16_t, 2> texCoords;  //Half floats
+        };
+
         struct Material {
             glm::vec3 ambient = glm::vec3(0.3f);
             glm::vec3 diffuse = glm::vec3(0.8f);
             glm::vec3 specular = glm::vec3(0.5f);
 
-            std::optional<uint> texture_diffuse = std::nullopt;
+            std::shared_ptr<const GLTexture> texture_diffuse = nullptr;  //Shared between copies of the material
+            bool worldTexCoords = false;                                 //Sample the texture at the world xz-coordinates instead of the vertex ones
+        };
+
+        //In mesh coordinates, computed whenever the vertices change
+        struct Bounds {
+            glm::vec3 min = glm::vec3(0.f), max = glm::vec3(0.f);  //Axis-aligned box
+            glm::vec3 center = glm::vec3(0.f);                      //Sphere around the center of the box
+            float radius = 0.f;
+        };
+
+        //Simplified index range within the element buffer, sharing the vertices of the full mesh
+        struct LOD {
+            uint indexOffset = 0;
+            uint indexCount = 0;
+            float error = 0.f;  //Deviation from the full mesh, in mesh coordinates
         };
 
     public:
         Mesh(const std::vector<Vertex> &vertices, const std::vector<uint> &indices);
         Mesh(const std::vector<Vertex> &vertices, const std::vector<uint> &indices, const Material &material);
+        Mesh(const std::vector<Vertex> &vertices, const std::vector<uint> &indices, const std::optional<Material> &material, const std::vector<uint> &lodIndices,
+             const std::vector<LOD> &lods);  //With levels of detail from `computeLODs`
+        Mesh(const Mesh &other);  //Uploads the data into new GL buffers
+        Mesh(Mesh &&other) noexcept = default;
         ~Mesh() = default;
 
-        void draw(const std::optional<Eigen::Vector3d> &color) const;
+        Mesh &operator=(const Mesh &other);
+        Mesh &operator=(Mesh &&other) noexcept = default;
 
+        void draw(const std::optional<Eigen::Vector3d> &color, const uint &lod = 0) const;  //Expects the variant returned by `getVariant` to be active
+        void drawInstanced(const std::vector<Instance> &instances, const uint &objectID = 0) const;  //Expects the instanced variant to be active
+
+        void updateVertices(const std::vector<Vertex> &vertices);  //Reuses the GL buffers and switches them to dynamic usage. Drops the levels of detail
+        void updateIndices(const std::vector<uint> &indices);  //Drops the levels of detail
+
+        void generateLODs(const std::vector<float> &ratios = {0.5f, 0.25f, 0.1f});  //Index count per level relative to the full mesh, levels which barely simplify are skipped
+        static void computeLODs(const std::vector<Vertex> &vertices, const std::vector<uint> &indices, const std::vector<float> &ratios,
+                                std::vector<uint> &lodIndices, std::vector<LOD> &lods);  //Same as `generateLODs` without GL, such that it can run on any thread
+        uint selectLOD(const glm::mat4 &pose) const;           //Coarsest level whose error stays below `lodPixelError` on screen, 0 is the full mesh
+        uint getNumberOfLODs() const;                          //Including the full mesh
+
+        void setupVertexAttributes() const;  //Attaches the buffers of this mesh to the bound vertex array
+        void setLayoutUniforms() const;      //Dequantization of packed positions, for the active variant
+
+        uint getVariant(const std::optional<Eigen::Vector3d> &color) const;  //Shader variant used by `draw`
+        uint getLayoutVariant() const;                                       //Bits of the vertex layout, to be added to every variant drawing this mesh
         const std::vector<Vertex>& getVertices() const;
         const std::vector<uint>& getIndices() const;
         const std::optional<Material>& getMaterial() const;
+        const Bounds& getBounds() const;
+        const BVH& getBVH() const;  //Built on first use (thread safe), dropped whenever vertices or indices change
+        size_t getCPUBytes() const;  //Vertices and indices kept in memory
+        size_t getGPUBytes() const;  //Buffers, excluding the texture which may be shared with other meshes
+        size_t getPackingSavings() const;  //Vertex buffer bytes saved by the packed layout, 0 for full floats
+
+    private:
+        //Share of a mesh in `packingStatistics`, which moves along with the mesh
+        class PackingAccount {
+        public:
+            PackingAccount() = default;
+            ~PackingAccount() {
+                set(0);
+            }
+
+            PackingAccount(PackingAccount &&other) noexcept : savedBytes(std::exchange(other.savedBytes, 0)) {}
+            PackingAccount &operator=(PackingAccount &&other) noexcept {
+                if (this != &other) {
+                    set(0);
+                    savedBytes = std::exchange(other.savedBytes, 0);
+                }
+                return *this;
+            }
+
+            void set(const size_t &savedBytes) {
+                packingStatistics.meshes += (long long)(savedBytes > 0) - (long long)(this->savedBytes > 0);
+                packingStatistics.savedBytes += (long long)savedBytes - (long long)this->savedBytes;
+                this->savedBytes = savedBytes;
+            }
+
+            size_t get() const {
+                return savedBytes;
+            }
+
+        private:
+            size_t savedBytes = 0;
+        };
 
     private:
         void setup();
+        void setupInstancing() const;
+        void computeBounds();
+        void uploadVertices(const uint &usage);  //Packed if required by the layout
+        void uploadIndices(const uint &usage);   //Full mesh followed by all levels of detail
 
     private:
         std::vector<Vertex> vertices;
         std::vector<uint> indices;
+        std::vector<uint> lodIndices;  //Of all levels, appended to the full mesh in the element buffer
+        std::vector<LOD> lods;
         std::optional<Material> material;
-        uint VAO, VBO, EBO;
+        Bounds bounds;
+        bool isPacked = packVertices;  //Layout of the vertex buffer, fixed when the mesh is created
+        PackingAccount packingAccount;
+        GLVertexArray VAO;
+        GLBuffer VBO, EBO;
+        mutable GLBuffer instanceVBO;  //Created on first instanced draw
+        mutable std::shared_ptr<const BVH> bvh = nullptr;
+        mutable const BVH *builtBVH = nullptr;  //Same as `bvh` once it is complete, read atomically without taking the lock
+    };
+
+    //Content of a file without any GL resources, such that it can be parsed on any thread
+    struct Data {
+        struct Image {
+            std::string filePath;  //Relative to the model file as returned by `importFile`, joined with its directory by `parse`
+            int width = 0, height = 0, components = 0;
+            std::vector<unsigned char> pixels;  //Empty if the file could not be decoded
+        };
+
+        struct Part {
+            std::vector<Mesh::Vertex> vertices;
+            std::vector<uint> indices;
+            int materialIndex = -1;  //Into `materials`, -1 for none
+            std::vector<uint> lodIndices;     //Optional, see `Mesh::computeLODs`
+            std::vector<Mesh::LOD> lods;
+        };
+
+        std::vector<Mesh::Material> materials;     //Textures are created by `uploadMaterial`
+        std::vector<std::optional<Image>> images;  //Diffuse texture per material
+        std::vector<Part> parts;                   //One mesh each
     };
 
 public:
     Model(const std::vector<Mesh> &meshes);
     Model(const std::string &filePath);
+    Model(const std::string &filePath, std::vector<Mesh> &&meshes);  //Does not load the file
     ~Model() = default;
 
-    static inline typename tools::Model::F_loadModel f_loadModel = [](tools::Model::UPtr &model, const std::string &filePath) -> void {
-        model = std::make_unique<gui::Model>(filePath);
-    };
+    static typename tools::Model::F_loadModel f_loadModel;  //Shares the meshes of identical files through the asset cache
 
     void draw(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation, const Eigen::Vector3d &scale, const std::optional<Eigen::Vector3d> &color,
               const double &alpha) const override;
+    void drawInstanced(const std::vector<Instance> &instances) const;
+    static void setUniforms(const glm::mat4 &pose, const glm::mat3 &normalMatrix, const float &alpha, const uint &objectID);  //Of the active non-instanced variant
 
     std::optional<HitInfo> hitByRay(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation, const Eigen::Vector3d &scale,
                                     const Ray &ray) const override;
-
-    void load(const std::string &filePath);
+    //Many rays against the same placed model (e.g. simulated range sensors), distributed over all cores
+    std::vector<std::optional<HitInfo>> castRays(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation, const Eigen::Vector3d &scale,
+                                                 std::span<const Ray> rays) const;
+
+    void load(const std::string &filePath, const bool &generateLODs = generateLODsOnLoad);
+    static Data parse(const std::string &filePath);                 //Does not touch GL, so it can run on a worker thread. Uses the mesh cache if possible
+    static void uploadMaterial(Data &data, const size_t &index);    //Creates the texture of a material
+    static Mesh uploadPart(const Data &data, const size_t &index);  //Expects the material of the part to be uploaded
     bool exportAsOBJ() const;
     void simplify(const float &threshold, const float &targetError, const bool &saveToFile);
+    void generateLODs(const std::vector<float> &ratios = {0.5f, 0.25f, 0.1f});
+
+private:
+    static Data importFile(const std::string &filePath, const uint &loadFlags);  //Through Assimp, stores the result in the mesh cache
 
 public:
     std::vector<Mesh> meshes;
+
+    static Statistics statistics;                           //Accumulated over all models, reset by the application every frame
+    static PackingStatistics packingStatistics;            //Updated whenever vertex buffers are created or released
+    static inline bool usePrecomputedNormalMatrix = true;  //Otherwise the vertex shader inverts the pose per vertex (for benchmarking)
+    static inline bool generateLODsOnLoad = false;
+    static inline bool packVertices = false;  //Layout of meshes created from now on, see `Mesh::PackedVertex`
+    static inline bool useLODs = true;
+    static inline float lodPixelError = 1.f;
+    static inline const View *view = nullptr;  //Set by the scene while it is drawn, the full meshes are drawn otherwise
+    static inline uint objectID = 0;           //Written into the ID buffer of the scene by the following draws (0 for none), reset by the scene
 };
 
 }  // namespace lenny::gui
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <lenny/gui/AssetCache.h>
+
+#include <deque>
+#include <memory>
+
+namespace lenny::gui {
+
+//Loads models in the background: files are parsed on worker threads, and their GL resources are created on the main thread within a time budget per frame.
+//Loaded models are shared through the asset cache, like the ones loaded directly
+class ModelLoader {
+private:  //Make constructor private, since we want to this to be a purely static class
+    ModelLoader() = default;
+    ~ModelLoader() = default;
+
+    struct Load;
+
+public:
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(const std::shared_ptr<const Model> &model);  //Of a model which is loaded already
+        ~Handle() = default;
+
+        bool isReady() const;
+        const std::shared_ptr<const Model> &get() const;  //Available right away, but without meshes until ready
+
+        //Draws a box around the parsed bounds (or a small one at the position if parsing is not done yet) until ready
+        void draw(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation, const Eigen::Vector3d &scale, const std::optional<Eigen::Vector3d> &color,
+                  const double &alpha) const;
+
+    private:
+        friend class ModelLoader;
+        std::shared_ptr<const Model> model;
+        std::shared_ptr<const Load> load;  //Null for models which were loaded already
+    };
+
+public:
+    static Handle load(const std::string &filePath, const bool &generateLODs = Model::generateLODsOnLoad);  //Cached or loading files are shared if they agree on the levels of detail
+    static void update();  //Called by the application every frame, uploads as much as the budget allows (but at least one texture or mesh)
+    static std::shared_ptr<const Model> await(const std::string &filePath, const bool &generateLODs);  //Finishes a pending load right away, nullptr if there is none
+    static uint getNumberOfPendingLoads();
+
+public:
+    static inline double uploadBudget = 0.002;  //Seconds per frame
+    static inline uint maxActiveLoads = 4;      //Files which are parsed or uploaded at the same time, further ones wait before being parsed
+
+private:
+    static void startParsing(const std::shared_ptr<Load> &load);
+    static void uploadStep(Load &load);  //One texture or mesh
+    static void finish(Load &load);      //Once everything is uploaded
+
+private:
+    static inline std::deque<std::shared_ptr<Load>> waitingLoads, activeLoads;
+};
+
+}  // namespace lenny::gui
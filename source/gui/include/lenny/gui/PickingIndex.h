@@ -0,0 +1,68 @@
+#pragma once
+
+#include <lenny/gui/Model.h>
+
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace lenny::gui {
+
+//Top-level BVH over the world bounds of placed models, returning the nearest hit among all of them
+class PickingIndex {
+public:
+    using Handle = uint;  //Stable until the index is cleared
+    struct Hit {
+        Handle handle;
+        tools::Model::HitInfo info;
+    };
+
+public:
+    PickingIndex() = default;
+    ~PickingIndex() = default;
+
+    //--- Objects (the models need to outlive the index)
+    Handle add(const Model& model, const Eigen::Vector3d& position, const Eigen::QuaternionD& orientation, const Eigen::Vector3d& scale);
+    void update(const Handle& handle, const Eigen::Vector3d& position, const Eigen::QuaternionD& orientation, const Eigen::Vector3d& scale);  //Refits the tree
+    void remove(const Handle& handle);
+    void clear();
+
+    //--- Queries
+    std::optional<Hit> hitByRay(const Ray& ray) const;
+    std::vector<std::optional<Hit>> castRays(std::span<const Ray> rays) const;  //Distributed over all cores
+
+private:
+    struct Object {
+        const Model* model;
+        Eigen::Vector3d position;
+        Eigen::QuaternionD orientation;
+        Eigen::Vector3d scale;
+        glm::vec3 min, max;  //World bounds
+        bool isActive;
+    };
+
+    //Children of inner nodes are stored next to each other and after their parent
+    struct Node {
+        glm::vec3 min;
+        uint leftOrFirst;  //Left child for inner nodes, first entry of `order` for leaves
+        glm::vec3 max;
+        uint count;  //Objects of leaves, 0 for inner nodes
+    };
+
+    static void computeBounds(Object& object);
+    void prepare() const;  //Rebuilds or refits the tree if necessary
+    void rebuild() const;
+    void refit() const;
+    void subdivide(const uint& nodeIndex, const uint& level) const;
+    void updateBounds(const uint& nodeIndex) const;
+
+private:
+    std::vector<Object> objects;
+
+    mutable std::vector<Node> nodes;
+    mutable std::vector<Handle> order;  //Active objects, such that every leaf references a consecutive range
+    mutable bool needsRebuild = false, needsRefit = false;
+    mutable uint depth = 0;  //Level of the deepest leaf, which bounds the traversal stack
+};
+
+}  // namespace lenny::gui
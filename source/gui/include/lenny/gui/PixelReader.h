@@ -0,0 +1,41 @@
+#pragma once
+
+#include <lenny/gui/GLResource.h>
+
+#include <glm/glm.hpp>
+#include <array>
+#include <optional>
+
+struct __GLsync;  //Declared by glad, which is kept out of the headers
+
+namespace lenny::gui {
+
+//Reads single 32 bit pixels of a framebuffer through a ring of pixel buffer objects, without waiting for the GPU
+class PixelReader {
+public:
+    struct Pixel {
+        uint request;  //Number returned by `request`
+        int x, y;
+        uint value;  //Raw bits, e.g. to be cast to float for depth
+    };
+    static constexpr uint ringSize = 3;  //Maximum number of pending requests
+
+public:
+    PixelReader(const uint& format, const uint& type, const uint& attachment);  //Attachment is ignored for depth and stencil formats
+    ~PixelReader();
+
+    PixelReader(const PixelReader&) = delete;
+    PixelReader& operator=(const PixelReader&) = delete;
+
+    uint request(const int& x, const int& y);  //From the bound read framebuffer, drops the oldest pending request if the ring is full
+    std::optional<Pixel> poll();               //Newest request which completed since the last poll
+
+private:
+    const uint format, type, attachment;
+    std::array<GLBuffer, ringSize> buffers;
+    std::array<__GLsync*, ringSize> fences = {};  //Pending requests
+    std::array<Pixel, ringSize> pixels = {};
+    uint numberOfRequests = 0;  //The next request goes into slot `numberOfRequests % ringSize`, the oldest pending one follows it
+};
+
+}  // namespace lenny::gui
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <lenny/gui/GLResource.h>
+#include <lenny/tools/Typedefs.h>
+
+#include <glm/glm.hpp>
+#include <mutex>
+#include <vector>
+
+namespace lenny::gui {
+
+//Points uploaded once into a GL buffer and expanded into a tube on the GPU: one instanced cylinder per segment and one instanced sphere per point
+class Polyline {
+public:
+    Polyline() = default;
+    ~Polyline() = default;
+
+    Polyline(const Polyline&) = delete;
+    Polyline& operator=(const Polyline&) = delete;
+
+    //--- Points (thread safe, uploaded with the next draw)
+    void set(const std::vector<Eigen::Vector3d>& points);  //Skips the upload if the points did not change
+    void append(const Eigen::Vector3d& point);               //Only the new points are uploaded
+    void clear();
+    void removeFront(const size_t& count);  //Uploads the remaining points again
+    size_t getNumberOfPoints() const;
+
+    //--- Drawing
+    void draw(const double& radius, const Eigen::Vector4d& color, const bool& showDots) const;  //Dots have twice the radius of the tube
+
+private:
+    size_t upload() const;  //Returns the number of uploaded points
+    void setupVertexArrays() const;
+    void drawInstances(const uint& variant, const size_t& count, const float& radius, const glm::vec4& color) const;
+
+private:
+    std::vector<glm::vec3> points;
+    mutable std::mutex mutex;
+    mutable size_t uploadedPoints = 0;
+
+    mutable GLBuffer pointBuffer;  //Grows by doubling, created on first draw
+    mutable size_t capacity = 0;
+    mutable GLVertexArray tubeVAO, jointVAO;
+};
+
+}  // namespace lenny::gui
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <lenny/gui/Model.h>
+
+#include <functional>
+#include <vector>
+
+namespace lenny::gui {
+
+class RenderQueue {
+public:
+    struct Item {
+        const Model::Mesh* mesh = nullptr;
+        uint variant = 0;
+        uint texture = 0;
+        bool isTransparent = false;
+        float distance = 0.f;  //Between camera and item origin
+        int instanceList = -1;  //Index into the instance lists of the queue, -1 for single draws
+
+        glm::mat4 pose = glm::mat4(1.f);
+        glm::mat3 normalMatrix = glm::mat3(1.f);
+        std::optional<Eigen::Vector3d> color = std::nullopt;
+        float alpha = 1.f;
+        uint lod = 0;
+        uint objectID = 0;  //Of the ID buffer, taken from the model when recorded
+
+        std::function<void()> f_draw = nullptr;  //Custom items draw themselves
+    };
+
+public:
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+
+    //--- Recording
+    void begin(const glm::vec3& cameraPosition);
+    void add(const Model::Mesh& mesh, const glm::mat4& pose, const glm::mat3& normalMatrix, const std::optional<Eigen::Vector3d>& color, const float& alpha,
+             const uint& lod = 0);
+    void addInstanced(const Model::Mesh& mesh, const std::vector<Model::Instance>& instances);  //Always drawn in the opaque pass
+    void addCustom(const std::function<void()>& f_draw, const uint& variant, const glm::vec3& position, const bool& isTransparent);
+
+    //--- Drawing
+    void execute();
+
+public:
+    inline static RenderQueue* current = nullptr;  //Set by the scene while it is recorded, draws are executed immediately otherwise
+    inline static bool enabled = true;
+
+private:
+    glm::vec3 cameraPosition = glm::vec3(0.f);
+    std::vector<Item> items;
+    std::vector<std::vector<Model::Instance>> instanceLists;  //Kept across frames to reuse their memory
+    uint usedInstanceLists = 0;
+};
+
+}  // namespace lenny::gui
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <lenny/gui/Model.h>
+#include <lenny/gui/Polyline.h>
 #include <lenny/tools/Renderer.h>
 
+#include <map>
+#include <span>
+#include <tuple>
+
 namespace lenny::gui {
 
 class Renderer : public tools::Renderer {
@@ -41,8 +47,65 @@ public:
     void drawRoundedPlane(const Eigen::Vector3d& COM, const Eigen::QuaternionD& orientation, const Eigen::Vector2d& dimensions, const double& radius,
                           const Eigen::Vector4d& color) const override;
 
+    //--- Bulk draw functions (radii and colors hold either one entry per element or a single entry shared by all elements)
+    static void drawSpheres(std::span<const Eigen::Vector3d> centers, std::span<const double> radii, std::span<const Eigen::Vector4d> colors);
+    static void drawCylinders(std::span<const Eigen::Vector3d> startPositions, std::span<const Eigen::Vector3d> endPositions, std::span<const double> radii,
+                              std::span<const Eigen::Vector4d> colors);
+    static void drawCapsules(std::span<const Eigen::Vector3d> startPositions, std::span<const Eigen::Vector3d> endPositions, std::span<const double> radii,
+                             std::span<const Eigen::Vector4d> colors);
+    static void drawArrows(std::span<const Eigen::Vector3d> startPositions, std::span<const Eigen::Vector3d> directions, std::span<const double> radii,
+                           std::span<const Eigen::Vector4d> colors);
+
+    //--- Debug draw functions (unlit, collected into a streaming buffer and drawn as lines and points once per scene)
+    static void drawDebugLine(const Eigen::Vector3d& startPosition, const Eigen::Vector3d& endPosition, const Eigen::Vector4d& color);
+    static void drawDebugPoint(const Eigen::Vector3d& position, const Eigen::Vector4d& color);
+    static void drawDebugBox(const Eigen::Vector3d& COM, const Eigen::QuaternionD& orientation, const Eigen::Vector3d& dimensions,
+                             const Eigen::Vector4d& color);
+
+    //--- Batching
+    static void flush();
+    static void flushDebug();  //After everything else of the scene is drawn
+
+private:
+    enum PRIMITIVE { CUBE, SPHERE, CYLINDER, CONE };
+    struct Batch {
+        std::shared_ptr<const gui::Model> model;
+        std::vector<Model::Instance> instances;
+        uint idleFlushes = 0;  //Flushes since the last use
+    };
+    using SectorKey = std::tuple<int, int, int>;  //Quantized angle range and number of segments
+    struct DebugVertex {
+        glm::vec3 position;
+        uint color;  //RGBA8
+    };
+
+    static const Polyline& getPolyline(const std::vector<Eigen::Vector3d>& points);
+    static Batch& getBatch(const PRIMITIVE& primitive);
+    static Batch& getSectorBatch(const std::pair<double, double>& angleRange);
+    static void drawBatch(const PRIMITIVE& primitive);
+    static void drawBatch(Batch& batch);
+    static void addInstance(const PRIMITIVE& primitive, const glm::mat4& pose, const Eigen::Vector4d& color);
+    static void addInstance(Batch& batch, const glm::mat4& pose, const Eigen::Vector4d& color);
+    static void pushInstance(const PRIMITIVE& primitive, const Model::Instance& instance);
+    static void pushInstance(Batch& batch, const Model::Instance& instance);
+    static bool checkBulkSizes(const std::string& description, const size_t& count, const std::vector<size_t>& sizes);
+
 public:
-    static std::function<std::shared_ptr<gui::Model>(const std::string&)> f_createModel;
+    static std::function<std::shared_ptr<const gui::Model>(const std::string&)> f_createModel;  //Through the asset cache by default
+    static inline bool useInstancing = true;  //Collect primitives and draw them instanced on `flush`
+    static inline double sectorResolution = PI / 180.0;  //Maximal angle covered by one segment of a sector
+    static inline float debugPointSize = 4.f;            //In pixels
+
+private:
+    static inline std::vector<Batch> batches;  //Indexed by PRIMITIVE, created on first use
+    static inline std::map<SectorKey, Batch> sectorBatches;  //Generated on first use, removed after being idle for a while
+    static inline std::vector<std::shared_ptr<gui::Model>> tetrahedra;
+    static inline size_t usedTetrahedra = 0;  //Since the last flush
+    static inline std::vector<std::unique_ptr<Polyline>> polylines;
+    static inline size_t usedPolylines = 0;  //Since the last flush
+    static inline std::vector<DebugVertex> debugLines, debugPoints;  //Since the last debug flush
+    static inline GLVertexArray debugVAO;
+    static inline GLBuffer debugVBO;  //Respecified every debug flush
 };
 
 }  // namespace lenny::gui
\ No newline at end of file
@@ -1,12 +1,17 @@
 #pragma once
 
 #include <lenny/gui/Camera.h>
+#include <lenny/gui/Frustum.h>
 #include <lenny/gui/Ground.h>
 #include <lenny/gui/Light.h>
+#include <lenny/gui/PixelReader.h>
+#include <lenny/gui/RenderQueue.h>
+#include <lenny/gui/Shaders.h>
 #include <lenny/tools/Typedefs.h>
 
 #include <array>
 #include <functional>
+#include <optional>
 
 namespace lenny::gui {
 
@@ -14,7 +19,7 @@ class Scene {
 public:
     LENNY_GENERAGE_TYPEDEFS(Scene)
     Scene(const std::string& description, const int& width, const int& height);
-    ~Scene();
+    ~Scene() = default;
 
     //--- Drawing
     void draw();
@@ -33,6 +38,8 @@ public:
     void copyCallbacksFromOtherScene(const Scene::CSPtr otherScene);
     void sync(const Scene::CSPtr otherScene);
     bool saveScreenshotToFile(const std::string& filePath) const;
+    uint getHoveredID() const;                          //`Model::objectID` under the cursor as of one frame ago, 0 if none or if picking is disabled
+    std::optional<Eigen::Vector3d> getCursorPoint() const;  //Surface point under the cursor as of one frame ago, from the depth buffer
 
 public:
     //--- Functions
@@ -52,11 +59,26 @@ public:
 
     bool showGround = true;
     bool showOrigin = true;
+    bool usePicking = false;  //Writes object IDs into a second attachment and reads back the one under the cursor
 
 private:
     std::array<float, 2> windowPos = {0.f, 0.f}, windowSize = {100.f, 100.f};
     bool blockCallbacks = false;
-    uint frameBuffer, texture, renderBuffer;
+    GLFramebuffer frameBuffer;
+    GLTexture texture;
+    GLRenderbuffer renderBuffer;
+    GLTexture idTexture;
+    PixelReader idReader;
+    uint hoveredID = 0;
+    PixelReader depthReader;
+    std::array<glm::mat4, PixelReader::ringSize> depthTransforms;  //From normalized device to world coordinates, per pending request
+    std::optional<Eigen::Vector3d> cursorPoint;
+    std::array<double, 2> mousePos = {-1.0, -1.0};
+    GLBuffer sceneBuffer;
+    Shaders::SceneData sceneData;  //Last uploaded content of the scene buffer
+    RenderQueue renderQueue;
+    Frustum frustum;  //Of the last draw, including its culling statistics
+    Model::View view;
     int textureWidth, textureHeight;
 };
 
@@ -1,17 +1,40 @@
 #pragma once
 
+#include <lenny/gui/GLResource.h>
+
 #include <glm/glm.hpp>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 namespace lenny::gui {
 
 class Shader {
 public:
-    Shader(const std::string &vertexPath, const std::string &fragmentPath);
+    //--- Typed handle to a uniform, which is resolved once per shader and then reused
+    template <typename T>
+    class Uniform {
+    public:
+        explicit Uniform(const std::string &name) : id(Shader::registerUniformName(name)) {}
+        const unsigned int id;
+    };
+
+    //--- Statistics
+    struct Statistics {
+        unsigned long long nameLookups = 0;    //Lookups of a uniform location by its name
+        unsigned long long driverLookups = 0;  //Calls to `glGetUniformLocation`
+        unsigned long long programSwitches = 0;  //Calls to `glUseProgram` through `activate`
+    };
+
+public:
+    Shader(const std::string &vertexPath, const std::string &fragmentPath, const std::vector<std::string> &defines = {});
     ~Shader() = default;
 
     void activate() const;
 
+    template <typename T>
+    void set(const Uniform<T> &uniform, const std::type_identity_t<T> &value) const;
+
     void setBool(const std::string &name, bool value) const;
     void setInt(const std::string &name, int value) const;
     void setFloat(const std::string &name, float value) const;
@@ -26,16 +49,51 @@ public:
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
 
     unsigned int getID() const;
+    int getUniformLocation(const std::string &name) const;
 
 private:
-    void load(const std::string &vertexPath, const std::string &fragmentPath);
-    void getCodeFromFile(std::string &code, const std::string &path) const;
+    void load(const std::string &vertexPath, const std::string &fragmentPath, const std::vector<std::string> &defines);
+    void getCodeFromFile(std::string &code, const std::string &path, const std::vector<std::string> &defines) const;
+    void reflectUniforms();
+    int getUniformLocation(const unsigned int &id) const;
 
     void checkShaderCompilationErrors(const unsigned int shader, const std::string& type) const;
     void checkProgramCompilationErrors(const unsigned int program) const;
 
+    static unsigned int registerUniformName(const std::string &name);
+    static std::vector<std::string> &getUniformNames();
+
+public:
+    static Statistics statistics;  //Accumulated over all shaders, reset by the application every frame
+
 private:
-    unsigned int ID;  //Set in load function
+    struct UniformInfo {
+        std::string name;
+        int location;
+    };
+
+    GLProgram program;                           //Set in load function
+    std::vector<UniformInfo> uniformTable;       //Active uniforms sorted by name, set in load function
+    mutable std::vector<int> locationsByHandle;  //Location per registered uniform handle id, resolved on first use
 };
 
-}  // namespace lenny::gui
\ No newline at end of file
+template <>
+void Shader::set(const Uniform<bool> &uniform, const bool &value) const;
+template <>
+void Shader::set(const Uniform<int> &uniform, const int &value) const;
+template <>
+void Shader::set(const Uniform<uint> &uniform, const uint &value) const;
+template <>
+void Shader::set(const Uniform<float> &uniform, const float &value) const;
+template <>
+void Shader::set(const Uniform<glm::vec2> &uniform, const glm::vec2 &value) const;
+template <>
+void Shader::set(const Uniform<glm::vec3> &uniform, const glm::vec3 &value) const;
+template <>
+void Shader::set(const Uniform<glm::vec4> &uniform, const glm::vec4 &value) const;
+template <>
+void Shader::set(const Uniform<glm::mat3> &uniform, const glm::mat3 &value) const;
+template <>
+void Shader::set(const Uniform<glm::mat4> &uniform, const glm::mat4 &value) const;
+
+}  // namespace lenny::gui
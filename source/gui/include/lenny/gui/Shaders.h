@@ -4,6 +4,7 @@
 #include <lenny/gui/Light.h>
 #include <lenny/gui/Shader.h>
 
+#include <map>
 #include <vector>
 
 namespace lenny::gui {
@@ -13,17 +14,42 @@ private:  //Make constructor private, since we want to this to be a purely stati
     Shaders() = default;
     ~Shaders() = default;
 
-private:
-    static std::vector<Shader> shaderList;
-
 public:
-    enum SHADERS { BASIC };
-    static Shader* activeShader;
+    enum SHADERS { BASIC, DEBUG };  //DEBUG is unlit and only reads positions and colors
+    //Compile-time permutations of a shader, injected as preprocessor defines. Flags can be combined
+    //TUBE and JOINT expand the points of a `Polyline` into segments and joints
+    enum VARIANT : uint { COLOR = 0, MATERIAL = 1 << 0, TEXTURE = 1 << 1, WORLD_TEXCOORDS = 1 << 2, INSTANCED = 1 << 3, TUBE = 1 << 4, JOINT = 1 << 5, PACKED = 1 << 6 };
+    static Shader* activeShader;  //Currently bound variant
+
+    //Camera and light data, shared by all shaders through the std140 uniform block declared in `data/shaders/scene.glsl`
+    struct SceneData {
+        glm::mat4 cameraProjection = glm::mat4(0.f);
+        glm::mat4 cameraView = glm::mat4(0.f);
+        glm::vec4 cameraPosition = glm::vec4(0.f);
+        glm::vec4 lightPosition = glm::vec4(0.f);
+        glm::vec4 lightColor = glm::vec4(0.f);
+        glm::vec4 lightGlow = glm::vec4(0.f);
+        glm::vec4 lightStrength = glm::vec4(0.f);  //x: ambient, y: diffuse, z: specular
+    };
+    static constexpr uint sceneDataBinding = 0;
 
 public:
     static void initialize();
-    static void update(const Camera& camera, const Light& light);
+    static GLBuffer generateSceneBuffer();
+    static void update(const GLBuffer& sceneBuffer, SceneData& sceneData, const Camera& camera, const Light& light);
     static void setActiveShader(SHADERS shader);
+    static void useVariant(const uint& variant);                  //Of the active shader, only switches program if necessary
+    static void use(SHADERS shader, const uint& variant = COLOR);  //Binds any shader without changing the active one
+    static uint getNumberOfCompiledVariants();
+
+private:
+    static Shader* getVariant(SHADERS shader, const uint& variant);
+
+private:
+    static std::vector<std::pair<std::string, std::string>> shaderFiles;  //Vertex and fragment path per shader
+    static std::map<std::pair<SHADERS, uint>, Shader> variants;          //Compiled on first use
+    static SHADERS activeType;
+    static bool activeShaderIsBound;
 };
 
-}  // namespace lenny::gui
\ No newline at end of file
+}  // namespace lenny::gui
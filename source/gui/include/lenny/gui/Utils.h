@@ -2,6 +2,7 @@
 
 #include <lenny/tools/Definitions.h>
 
+#include <functional>
 #include <glm/glm.hpp>
 
 namespace lenny::gui::utils {
@@ -9,5 +10,9 @@ namespace lenny::gui::utils {
 glm::vec3 toGLM(const Eigen::Vector3d& v);
 Eigen::Vector3d toEigen(const glm::vec3& v);
 glm::mat4 getGLMTransform(const Eigen::Vector3d& position, const Eigen::QuaternionD& orientation, const Eigen::Vector3d& scale);
+glm::mat3 getGLMNormalMatrix(const glm::mat4& transform);
+
+//Splits [0, count) into one contiguous range per hardware thread, small counts are processed on the calling thread
+void parallelFor(const size_t& count, const std::function<void(size_t, size_t)>& f_range, const size_t& minimumRangeSize = 256);
 
 }  // namespace lenny::gui::utils
\ No newline at end of file
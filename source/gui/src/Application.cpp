@@ -2,8 +2,12 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <lenny/gui/Application.h>
+#include <lenny/gui/AssetCache.h>
+#include <lenny/gui/GLResource.h>
 #include <lenny/gui/Gui.h>
+#include <lenny/gui/ModelLoader.h>
 #include <lenny/gui/Plot.h>
+#include <lenny/gui/RenderQueue.h>
 #include <lenny/gui/Renderer.h>
 #include <lenny/gui/Shaders.h>
 #include <lenny/tools/Logger.h>
@@ -33,7 +37,8 @@ Application::~Application() {
     ImPlot::DestroyContext();
     ImGui::DestroyContext();
 
-    //Terminate glfw
+    //Terminate glfw (resources released afterwards do not need to be deleted anymore)
+    GLResources::contextIsAlive = false;
     glfwDestroyWindow(this->glfwWindow);
     glfwTerminate();
 }
@@ -89,6 +94,7 @@ void Application::initializeOpenGL() {
     //Initialize glad
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
         LENNY_LOG_ERROR("Failed to initialize glad!");
+    GLResources::contextIsAlive = true;
 
     // Enable error callback
     glEnable(GL_DEBUG_OUTPUT);
@@ -289,6 +295,9 @@ void Application::run() {
             if (!process->separateThreadIsUsed() && process->isRunning())
                 process->step();
 
+        //Upload models which were loaded in the background
+        ModelLoader::update();
+
         //Draw
         prepareToDraw();
         draw();
@@ -355,6 +364,24 @@ void Application::drawMenuBar() {
             ImGui::SetNextItemWidth(50.f);
             ImGui::InputDouble(" ", &targetFramerate, 0.0, 0.0, "%.1f");
 
+            ImGui::Checkbox("Instanced Primitives", &Renderer::useInstancing);
+            ImGui::Checkbox("Sorted Render Queue", &RenderQueue::enabled);
+            ImGui::Checkbox("Levels of Detail", &Model::useLODs);
+            ImGui::SliderFloat("LOD Pixel Error", &Model::lodPixelError, 0.1f, 10.f);
+            ImGui::Checkbox("Packed Vertices (new meshes)", &Model::packVertices);
+            ImGui::Text("Uniform lookups per frame: %llu (driver: %llu)", shaderStatistics.nameLookups, shaderStatistics.driverLookups);
+            ImGui::Text("Program switches per frame: %llu (variants: %u)", shaderStatistics.programSwitches, Shaders::getNumberOfCompiledVariants());
+            ImGui::Text("Draw calls per frame: %llu (vertices: %llu)", modelStatistics.drawCalls, modelStatistics.vertices);
+            if (ImGui::TreeNode("GPU Resources")) {
+                GLResources::drawGui();
+                ImGui::Text("Packed meshes: %lld (saved: %.2f MB)", Model::packingStatistics.meshes, 1e-6 * (double)Model::packingStatistics.savedBytes);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("Assets")) {
+                AssetCache::drawGui();
+                ImGui::TreePop();
+            }
+
             ImGui::Separator();
             ImGui::Checkbox("Show Console", &showConsole);
             ImGui::Checkbox("Show Gui", &showGui);
@@ -398,6 +425,10 @@ double Application::getDt() const {
     return 1.0 / currentFramerate;
 }
 
+const Model::Statistics &Application::getModelStatistics() const {
+    return modelStatistics;
+}
+
 bool Application::saveScreenshotToFile(const std::string &filePath) const {
     //Check extension
     if (!tools::utils::checkFileExtension(filePath, "png")) {
@@ -428,6 +459,12 @@ bool Application::saveScreenshotToFile(const std::string &filePath) const {
 }
 
 void Application::draw() {
+    //Gather statistics of the previous frame
+    shaderStatistics = Shader::statistics;
+    Shader::statistics = Shader::Statistics();
+    modelStatistics = Model::statistics;
+    Model::statistics = Model::Statistics();
+
     //Prepare glfw
     const auto [windowWidth, windowHeight] = getCurrentWindowSize();
     if (windowWidth < 1 || windowHeight < 1)
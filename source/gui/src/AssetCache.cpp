@@ -0,0 +1,128 @@
+#include <lenny/gui/AssetCache.h>
+#include <lenny/gui/ImGui.h>
+#include <lenny/gui/ModelLoader.h>
+
+#include <filesystem>
+#include <set>
+
+namespace lenny::gui {
+
+AssetCache::Reference::Reference(const std::shared_ptr<const gui::Model> &asset) : tools::Model(asset->filePath), asset(asset) {}
+
+void AssetCache::Reference::draw(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation, const Eigen::Vector3d &scale,
+                                 const std::optional<Eigen::Vector3d> &color, const double &alpha) const {
+    asset->draw(position, orientation, scale, color, alpha);
+}
+
+std::optional<tools::Model::HitInfo> AssetCache::Reference::hitByRay(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation,
+                                                                     const Eigen::Vector3d &scale, const Ray &ray) const {
+    return asset->hitByRay(position, orientation, scale, ray);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::shared_ptr<const Model> AssetCache::get(const std::string &filePath, const bool &generateLODs) {
+    if (const std::shared_ptr<const Model> asset = find(filePath, generateLODs))
+        return asset;
+
+    //A background load of the file is finished instead of importing the file a second time, it adds the model to the cache
+    if (const std::shared_ptr<const Model> asset = ModelLoader::await(filePath, generateLODs))
+        return asset;
+
+    std::shared_ptr<Model> asset = std::make_shared<Model>(filePath, std::vector<Model::Mesh>());
+    asset->load(filePath, generateLODs);
+    assets.emplace(getKey(filePath, generateLODs), asset);
+    return asset;
+}
+
+std::shared_ptr<const Model> AssetCache::find(const std::string &filePath, const bool &generateLODs) {
+    const auto iter = assets.find(getKey(filePath, generateLODs));
+    return iter != assets.end() ? iter->second : nullptr;
+}
+
+void AssetCache::add(const std::shared_ptr<const Model> &model, const bool &generateLODs) {
+    assets.try_emplace(getKey(model->filePath, generateLODs), model);
+}
+
+bool AssetCache::evict(const std::string &filePath) {
+    const size_t count = assets.erase(getKey(filePath, false)) + assets.erase(getKey(filePath, true));
+    return count > 0;
+}
+
+uint AssetCache::evictUnused() {
+    uint count = 0;
+    for (auto iter = assets.begin(); iter != assets.end();) {
+        if (iter->second.use_count() == 1) {
+            iter = assets.erase(iter);
+            count++;
+        } else {
+            iter++;
+        }
+    }
+    return count;
+}
+
+AssetCache::Statistics AssetCache::getStatistics(const std::string &filePath, const bool &generateLODs) {
+    const auto iter = assets.find(getKey(filePath, generateLODs));
+    if (iter == assets.end())
+        return Statistics();
+
+    Statistics statistics;
+    statistics.users = iter->second.use_count() - 1;
+
+    //Meshes of a file often share their textures, which are only counted once
+    std::set<const GLTexture *> textures;
+    for (const Model::Mesh &mesh : iter->second->meshes) {
+        statistics.cpuBytes += mesh.getCPUBytes();
+        statistics.gpuBytes += mesh.getGPUBytes();
+        statistics.packingSavings += mesh.getPackingSavings();
+        if (mesh.getMaterial().has_value() && mesh.getMaterial()->texture_diffuse)
+            textures.insert(mesh.getMaterial()->texture_diffuse.get());
+    }
+    for (const GLTexture *texture : textures)
+        statistics.gpuBytes += texture->getBytes();
+    return statistics;
+}
+
+void AssetCache::drawGui() {
+    Statistics total;
+    std::optional<Key> evictedKey;
+    for (const auto &[key, asset] : assets) {
+        const Statistics statistics = getStatistics(key.first, key.second);
+        total.users += statistics.users;
+        total.cpuBytes += statistics.cpuBytes;
+        total.gpuBytes += statistics.gpuBytes;
+        total.packingSavings += statistics.packingSavings;
+
+        ImGui::PushID((key.first + (key.second ? "#LODs" : "")).c_str());
+        ImGui::Text("%s%s: %ld users (CPU: %.2f MB, GPU: %.2f MB)", std::filesystem::path(key.first).filename().string().c_str(), key.second ? " (LODs)" : "",
+                    statistics.users, 1e-6 * (double)statistics.cpuBytes, 1e-6 * (double)statistics.gpuBytes);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Evict"))
+            evictedKey = key;
+        if (ImGui::TreeNode("Meshes")) {
+            for (size_t i = 0; i < asset->meshes.size(); i++) {
+                const Model::Mesh &mesh = asset->meshes[i];
+                ImGui::Text("%zu: %zu vertices (GPU: %.1f KB, packed: %s, saved: %.1f KB)", i, mesh.getVertices().size(), 1e-3 * (double)mesh.getGPUBytes(),
+                            mesh.getLayoutVariant() ? "yes" : "no", 1e-3 * (double)mesh.getPackingSavings());
+            }
+            ImGui::TreePop();
+        }
+        ImGui::PopID();
+    }
+    if (evictedKey.has_value())
+        assets.erase(evictedKey.value());
+
+    ImGui::Separator();
+    ImGui::Text("Total: %zu assets (CPU: %.2f MB, GPU: %.2f MB, saved by packing: %.2f MB)", assets.size(), 1e-6 * (double)total.cpuBytes,
+                1e-6 * (double)total.gpuBytes, 1e-6 * (double)total.packingSavings);
+    if (ImGui::Button("Evict Unused"))
+        evictUnused();
+}
+
+AssetCache::Key AssetCache::getKey(const std::string &filePath, const bool &generateLODs) {
+    //Different spellings of the same path share an entry
+    return {std::filesystem::path(filePath).lexically_normal().generic_string(), generateLODs};
+}
+
+}  // namespace lenny::gui
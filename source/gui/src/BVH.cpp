@@ -0,0 +1,230 @@
+#include <lenny/gui/BVH.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace lenny::gui {
+
+inline float getSurfaceArea(const glm::vec3& min, const glm::vec3& max) {
+    const glm::vec3 extent = max - min;
+    return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+//Costs of the surface area heuristic, in units of testing one packet of triangles
+inline float getIntersectionCost(const uint& count, const uint& packetSize) {
+    return (float)((count + packetSize - 1) / packetSize);
+}
+static const float traversalCost = 1.f;  //Of visiting a node (two box tests and a stack operation)
+
+inline glm::vec3 getCentroid(const BVH::Triangle& triangle) {
+    return (triangle[0] + triangle[1] + triangle[2]) / 3.f;
+}
+
+BVH::BVH(const std::vector<Triangle>& triangles) : triangles(triangles) {
+    triangleIndices.resize(triangles.size());
+    for (uint i = 0; i < triangles.size(); i++)
+        triangleIndices[i] = i;
+
+    //A binary tree has at most 2N - 1 nodes
+    nodes.reserve(std::max<size_t>(2 * triangles.size(), 1));
+    nodes.push_back({glm::vec3(0.f), 0, glm::vec3(0.f), (uint)triangles.size()});
+    updateBounds(0);
+    subdivide(0, 0);
+    nodes.shrink_to_fit();
+
+    //Only the structure of arrays is used for queries. Padding triangles are degenerate and never hit
+    for (std::vector<float>& component : triangleData)
+        component.assign(this->triangles.size() + packetSize, 0.f);
+    for (size_t i = 0; i < this->triangles.size(); i++) {
+        const Triangle& triangle = this->triangles[i];
+        const glm::vec3 e1 = triangle[1] - triangle[0], e2 = triangle[2] - triangle[0];
+        for (int j = 0; j < 3; j++) {
+            triangleData[V0_X + j][i] = triangle[0][j];
+            triangleData[E1_X + j][i] = e1[j];
+            triangleData[E2_X + j][i] = e2[j];
+        }
+    }
+    this->triangles.clear();
+    this->triangles.shrink_to_fit();
+}
+
+std::optional<BVH::Hit> BVH::intersect(const glm::vec3& origin, const glm::vec3& direction, const float& tMax) const {
+    if (triangleIndices.empty())
+        return std::nullopt;
+
+    const glm::vec3 inverseDirection = glm::vec3(1.f) / direction;
+    std::optional<Hit> hit;
+    float tClosest = tMax;
+
+    traverse(nodes, depth, origin, inverseDirection, tClosest,
+             [&](const Node& node, float& t) -> void { intersectLeaf(node, origin, direction, t, hit); });
+    return hit;
+}
+
+uint BVH::getNumberOfNodes() const {
+    return (uint)nodes.size();
+}
+
+void BVH::intersectLeaf(const Node& node, const glm::vec3& origin, const glm::vec3& direction, float& tClosest, std::optional<Hit>& hit) const {
+    const float* v0x = triangleData[V0_X].data();
+    const float* v0y = triangleData[V0_Y].data();
+    const float* v0z = triangleData[V0_Z].data();
+    const float* e1x = triangleData[E1_X].data();
+    const float* e1y = triangleData[E1_Y].data();
+    const float* e1z = triangleData[E1_Z].data();
+    const float* e2x = triangleData[E2_X].data();
+    const float* e2y = triangleData[E2_Y].data();
+    const float* e2z = triangleData[E2_Z].data();
+    const uint last = node.leftOrFirst + node.count;
+
+    for (uint first = node.leftOrFirst; first < last; first += packetSize) {
+        //Möller-Trumbore without branches, with the same barycentric convention as glm::intersectRayTriangle
+        std::array<float, packetSize> t, u, v;
+        for (uint lane = 0; lane < packetSize; lane++) {
+            const uint i = first + lane;
+            const float px = direction.y * e2z[i] - direction.z * e2y[i];
+            const float py = direction.z * e2x[i] - direction.x * e2z[i];
+            const float pz = direction.x * e2y[i] - direction.y * e2x[i];
+            const float determinant = e1x[i] * px + e1y[i] * py + e1z[i] * pz;
+            const float inverseDeterminant = 1.f / determinant;
+
+            const float sx = origin.x - v0x[i], sy = origin.y - v0y[i], sz = origin.z - v0z[i];
+            const float qx = sy * e1z[i] - sz * e1y[i];
+            const float qy = sz * e1x[i] - sx * e1z[i];
+            const float qz = sx * e1y[i] - sy * e1x[i];
+            u[lane] = (sx * px + sy * py + sz * pz) * inverseDeterminant;
+            v[lane] = (direction.x * qx + direction.y * qy + direction.z * qz) * inverseDeterminant;
+            const float tLane = (e2x[i] * qx + e2y[i] * qy + e2z[i] * qz) * inverseDeterminant;
+
+            //Bitwise ands, since short-circuiting introduces branches which keep the compiler from vectorizing the loop
+            const bool isHit = (std::abs(determinant) >= std::numeric_limits<float>::epsilon()) & (u[lane] >= 0.f) & (v[lane] >= 0.f) &
+                               (u[lane] + v[lane] <= 1.f) & (tLane > 1e-8f) & (i < last);
+            t[lane] = isHit ? tLane : std::numeric_limits<float>::infinity();
+        }
+
+        for (uint lane = 0; lane < packetSize; lane++) {
+            if (t[lane] < tClosest) {
+                tClosest = t[lane];
+                hit = Hit{t[lane], glm::vec2(u[lane], v[lane]), triangleIndices[first + lane]};
+            }
+        }
+    }
+}
+
+void BVH::updateBounds(const uint& nodeIndex) {
+    Node& node = nodes[nodeIndex];
+    node.min = glm::vec3(std::numeric_limits<float>::max());
+    node.max = glm::vec3(-std::numeric_limits<float>::max());
+    for (uint i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+        for (const glm::vec3& vertex : triangles[i]) {
+            node.min = glm::min(node.min, vertex);
+            node.max = glm::max(node.max, vertex);
+        }
+    }
+}
+
+void BVH::subdivide(const uint& nodeIndex, const uint& level) {
+    depth = std::max(depth, level);
+    static const uint numberOfBins = 16;
+    struct Bin {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+        uint count = 0;
+    };
+
+    //Leaves are tested a packet at a time, so splitting one which fits into a packet cannot pay off
+    const uint first = nodes[nodeIndex].leftOrFirst, count = nodes[nodeIndex].count;
+    if (count <= packetSize)
+        return;
+
+    //Bounds of the centroids, which are binned along each axis
+    glm::vec3 centroidMin(std::numeric_limits<float>::max()), centroidMax(-std::numeric_limits<float>::max());
+    for (uint i = first; i < first + count; i++) {
+        const glm::vec3 centroid = getCentroid(triangles[i]);
+        centroidMin = glm::min(centroidMin, centroid);
+        centroidMax = glm::max(centroidMax, centroid);
+    }
+
+    //Find the cheapest split plane according to the surface area heuristic
+    const float area = getSurfaceArea(nodes[nodeIndex].min, nodes[nodeIndex].max);
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    float bestPosition = 0.f;
+    for (int axis = 0; axis < 3; axis++) {
+        if (centroidMax[axis] <= centroidMin[axis])
+            continue;
+
+        std::array<Bin, numberOfBins> bins;
+        const float binScale = (float)numberOfBins / (centroidMax[axis] - centroidMin[axis]);
+        for (uint i = first; i < first + count; i++) {
+            const uint binIndex = std::min(numberOfBins - 1, (uint)((getCentroid(triangles[i])[axis] - centroidMin[axis]) * binScale));
+            Bin& bin = bins[binIndex];
+            bin.count++;
+            for (const glm::vec3& vertex : triangles[i]) {
+                bin.min = glm::min(bin.min, vertex);
+                bin.max = glm::max(bin.max, vertex);
+            }
+        }
+
+        //Sweep from both sides to get the areas and counts of all splits between bins
+        std::array<float, numberOfBins - 1> leftArea, rightArea;
+        std::array<uint, numberOfBins - 1> leftCount, rightCount;
+        Bin left, right;
+        for (uint i = 0; i < numberOfBins - 1; i++) {
+            left.count += bins[i].count;
+            left.min = glm::min(left.min, bins[i].min);
+            left.max = glm::max(left.max, bins[i].max);
+            leftCount[i] = left.count;
+            leftArea[i] = left.count > 0 ? getSurfaceArea(left.min, left.max) : 0.f;
+
+            const uint j = numberOfBins - 1 - i;
+            right.count += bins[j].count;
+            right.min = glm::min(right.min, bins[j].min);
+            right.max = glm::max(right.max, bins[j].max);
+            rightCount[j - 1] = right.count;
+            rightArea[j - 1] = right.count > 0 ? getSurfaceArea(right.min, right.max) : 0.f;
+        }
+        for (uint i = 0; i < numberOfBins - 1; i++) {
+            const float cost = traversalCost * area + getIntersectionCost(leftCount[i], packetSize) * leftArea[i] +
+                               getIntersectionCost(rightCount[i], packetSize) * rightArea[i];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestPosition = centroidMin[axis] + (float)(i + 1) / binScale;
+            }
+        }
+    }
+
+    //Keep a leaf if splitting does not pay off
+    const float leafCost = getIntersectionCost(count, packetSize) * area;
+    if (bestAxis < 0 || bestCost >= leafCost)
+        return;
+
+    //Partition the triangles
+    uint i = first, j = first + count;
+    while (i < j) {
+        if (getCentroid(triangles[i])[bestAxis] < bestPosition) {
+            i++;
+        } else {
+            j--;
+            std::swap(triangles[i], triangles[j]);
+            std::swap(triangleIndices[i], triangleIndices[j]);
+        }
+    }
+    const uint leftCount = i - first;
+    if (leftCount == 0 || leftCount == count)
+        return;
+
+    //Create children (the reference into the node array is invalidated by pushing)
+    const uint leftIndex = (uint)nodes.size();
+    nodes.push_back({glm::vec3(0.f), first, glm::vec3(0.f), leftCount});
+    nodes.push_back({glm::vec3(0.f), i, glm::vec3(0.f), count - leftCount});
+    nodes[nodeIndex].leftOrFirst = leftIndex;
+    nodes[nodeIndex].count = 0;
+    updateBounds(leftIndex);
+    updateBounds(leftIndex + 1);
+    subdivide(leftIndex, level + 1);
+    subdivide(leftIndex + 1, level + 1);
+}
+
+}  // namespace lenny::gui
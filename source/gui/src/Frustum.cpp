@@ -0,0 +1,67 @@
+#include <lenny/gui/Frustum.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace lenny::gui {
+
+Frustum::Frustum(const glm::mat4& projectionView) : isEmpty(false) {
+    //Planes from the rows of the combined matrix (Gribb and Hartmann): left, right, bottom, top, near, far
+    auto row = [&](const int& i) -> glm::vec4 { return glm::vec4(projectionView[0][i], projectionView[1][i], projectionView[2][i], projectionView[3][i]); };
+    for (int i = 0; i < 3; i++) {
+        planes[2 * i] = row(3) + row(i);
+        planes[2 * i + 1] = row(3) - row(i);
+    }
+    for (glm::vec4& plane : planes)
+        plane = plane / glm::length(glm::vec3(plane));
+}
+
+bool Frustum::isVisible(const Model::Mesh::Bounds& bounds, const glm::mat4& pose) const {
+    const bool isVisible = test(bounds, pose);
+    isVisible ? statistics.visible++ : statistics.culled++;
+    return isVisible;
+}
+
+void Frustum::cull(const Model::Mesh::Bounds& bounds, const std::vector<Model::Instance>& instances, std::vector<Model::Instance>& visibleInstances) const {
+    visibleInstances.clear();
+    for (const Model::Instance& instance : instances)
+        if (test(bounds, instance.pose))
+            visibleInstances.push_back(instance);
+    statistics.visible += visibleInstances.size();
+    statistics.culled += instances.size() - visibleInstances.size();
+}
+
+bool Frustum::test(const Model::Mesh::Bounds& bounds, const glm::mat4& pose) const {
+    if (isEmpty)
+        return true;
+
+    //Bounding sphere first: decides most cases with one dot product per plane
+    const glm::mat3 linear(pose);
+    const glm::vec3 center = glm::vec3(pose * glm::vec4(bounds.center, 1.f));
+    const float scale = std::sqrt(std::max({glm::dot(linear[0], linear[0]), glm::dot(linear[1], linear[1]), glm::dot(linear[2], linear[2])}));
+    const float radius = scale * bounds.radius;
+    bool isInside = true;
+    for (const glm::vec4& plane : planes) {
+        const float distance = glm::dot(glm::vec3(plane), center) + plane[3];
+        if (distance < -radius)
+            return false;
+        isInside = isInside && distance >= radius;
+    }
+    if (isInside)
+        return true;
+
+    //Box, enclosed by a world-aligned box around the transformed one
+    const glm::vec3 boxCenter = glm::vec3(pose * glm::vec4(0.5f * (bounds.min + bounds.max), 1.f));
+    const glm::vec3 halfExtents = 0.5f * (bounds.max - bounds.min);
+    glm::vec3 worldHalfExtents(0.f);
+    for (int i = 0; i < 3; i++)
+        worldHalfExtents += glm::abs(linear[i]) * halfExtents[i];
+    for (const glm::vec4& plane : planes) {
+        const glm::vec3 normal(plane);
+        if (glm::dot(normal, boxCenter) + plane[3] < -glm::dot(glm::abs(normal), worldHalfExtents))
+            return false;
+    }
+    return true;
+}
+
+}  // namespace lenny::gui
@@ -0,0 +1,73 @@
+#include <glad/glad.h>
+#include <lenny/gui/GLResource.h>
+#include <lenny/gui/ImGui.h>
+
+namespace lenny::gui {
+
+std::array<GLResources::Usage, GLResources::NUMBER_OF_TYPES> GLResources::usage = {};
+bool GLResources::contextIsAlive = false;
+
+unsigned int GLResources::generate(const TYPE& type) {
+    GLuint id = 0;
+    switch (type) {
+        case BUFFER:
+            glGenBuffers(1, &id);
+            break;
+        case VERTEX_ARRAY:
+            glGenVertexArrays(1, &id);
+            break;
+        case TEXTURE:
+            glGenTextures(1, &id);
+            break;
+        case FRAMEBUFFER:
+            glGenFramebuffers(1, &id);
+            break;
+        case RENDERBUFFER:
+            glGenRenderbuffers(1, &id);
+            break;
+        case PROGRAM:
+            id = glCreateProgram();
+            break;
+        default:
+            break;
+    }
+    usage[type].count++;
+    return id;
+}
+
+void GLResources::destroy(const TYPE& type, const unsigned int& id) {
+    usage[type].count--;
+    if (!contextIsAlive)
+        return;
+
+    switch (type) {
+        case BUFFER:
+            glDeleteBuffers(1, &id);
+            break;
+        case VERTEX_ARRAY:
+            glDeleteVertexArrays(1, &id);
+            break;
+        case TEXTURE:
+            glDeleteTextures(1, &id);
+            break;
+        case FRAMEBUFFER:
+            glDeleteFramebuffers(1, &id);
+            break;
+        case RENDERBUFFER:
+            glDeleteRenderbuffers(1, &id);
+            break;
+        case PROGRAM:
+            glDeleteProgram(id);
+            break;
+        default:
+            break;
+    }
+}
+
+void GLResources::drawGui() {
+    static const std::array<const char*, NUMBER_OF_TYPES> names = {"Buffers", "Vertex Arrays", "Textures", "Framebuffers", "Renderbuffers", "Programs"};
+    for (int i = 0; i < NUMBER_OF_TYPES; i++)
+        ImGui::Text("%s: %lld (%.2f MB)", names[i], usage[i].count, 1e-6 * (double)usage[i].bytes);
+}
+
+}  // namespace lenny::gui
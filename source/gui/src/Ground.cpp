@@ -10,11 +10,18 @@ Ground::Ground(int size) {
 
 void Ground::setSize(const int size) {
     this->size = size;
+    if (mode == TILED)
+        updateTiledModel();
+}
+
+void Ground::updateTiledModel() {
+    if (tiledSize == size)
+        return;
+    tiledSize = size;
 
     //Reset model
     std::vector<Model::Mesh::Vertex> vertices;
     std::vector<uint> indices;
-    Model::Mesh::Material material = model.meshes.back().getMaterial().value();
     for (int i = -size; i < size; i++) {
         for (int j = -size; j < size; j++) {
             for(const auto& index : tile.meshes.back().getIndices()) {
@@ -26,16 +33,28 @@ void Ground::setSize(const int size) {
             }
         }
     }
-    model.meshes.back() = Model::Mesh(vertices, indices, material);
+    model.meshes.back().updateVertices(vertices);
+    model.meshes.back().updateIndices(indices);
 }
 
+Model Ground::createQuad(const Model& tile) {
+    const Model::Mesh& mesh = tile.meshes.back();
+    Model::Mesh::Material material = mesh.getMaterial().value();
+    material.worldTexCoords = true;
+    return Model({Model::Mesh(mesh.getVertices(), mesh.getIndices(), material)});
+}
 
 void Ground::drawScene() const {
-    model.draw(Eigen::Vector3d::Zero(), Eigen::QuaternionD::Identity(), Eigen::Vector3d::Ones(), std::nullopt, alpha);
+    if (mode == PROCEDURAL)
+        quad.draw(Eigen::Vector3d::Zero(), Eigen::QuaternionD::Identity(), Eigen::Vector3d(2.0 * size, 1.0, 2.0 * size), std::nullopt, alpha);
+    else
+        model.draw(Eigen::Vector3d::Zero(), Eigen::QuaternionD::Identity(), Eigen::Vector3d::Ones(), std::nullopt, alpha);
 }
 
 void Ground::drawGui() {
     if (ImGui::TreeNode("Ground")) {
+        if (ImGui::Combo("Mode", (int*)&mode, "Tiled\0Procedural\0"))
+            setSize(size);
         if(ImGui::SliderInt("Size", &size, 1, 100))
             setSize(size);
         ImGui::SliderDouble("Alpha", &alpha, 0.0, 1.0);
@@ -49,24 +68,29 @@ void Ground::drawGui() {
 void Ground::printSettings() const {
     using tools::Logger;
     LENNY_LOG_PRINT(Logger::DEFAULT, "--- GROUND SETTINGS ---\n");
+    LENNY_LOG_PRINT(Logger::DEFAULT, "ground.mode = %s;\n", mode == TILED ? "Ground::TILED" : "Ground::PROCEDURAL");
     LENNY_LOG_PRINT(Logger::DEFAULT, "ground.size = %d;\n", size);
     LENNY_LOG_PRINT(Logger::DEFAULT, "ground.alpha = %lf;\n", alpha);
     LENNY_LOG_PRINT(Logger::DEFAULT, "------------------------\n");
 }
 
 void Ground::to_json(json& j, const Ground& o) {
+    TO_JSON(o, mode)
     TO_JSON(o, size)
     TO_JSON(o, alpha)
 }
 
 void Ground::from_json(const json& j, Ground& o) {
+    FROM_JSON(o, mode)
     FROM_JSON(o, size)
     FROM_JSON(o, alpha)
+    o.setSize(o.size);
 }
 
 void Ground::sync(const Ground& otherGround) {
-    this->size = otherGround.size;
+    this->mode = otherGround.mode;
     this->alpha = otherGround.alpha;
+    setSize(otherGround.size);
 }
 
 }  // namespace lenny::gui
\ No newline at end of file
@@ -0,0 +1,394 @@
+#ifdef WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <lenny/gui/MeshCache.h>
+#include <lenny/tools/Logger.h>
+#include <lenny/tools/Timer.h>
+#include <meshoptimizer.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace lenny::gui {
+
+//Bump whenever the layout below or the content of `Model::Mesh::Vertex` changes
+static const uint32_t cacheVersion = 3;
+static const char cacheMagic[4] = {'L', 'N', 'Y', 'M'};
+static const size_t maxCodecRatio = 256;  //Generous bound on how far the codecs compress data, limits what corrupt entries can allocate
+
+//Layout: header, materials (colors, flag and texture path), parts (counts, vertices and indices). Everything is 4 byte aligned
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t loadFlags;
+    uint32_t vertexSize;
+    int64_t sourceTime;  //Last modification of the source file
+    uint64_t sourceSize;
+    uint64_t sourceHash;  //Of the content, such that touched but unchanged files still hit
+    uint32_t numberOfMaterials;
+    uint32_t numberOfParts;
+    uint32_t isCompressed;
+    uint32_t padding;
+};
+
+struct CacheMaterial {
+    glm::vec3 ambient, diffuse, specular;
+    uint32_t worldTexCoords;
+    uint32_t texturePathLength;  //Followed by the path, padded to 4 bytes
+};
+
+struct CachePart {
+    uint32_t numberOfVertices;
+    uint32_t numberOfIndices;
+    int32_t materialIndex;
+    uint32_t encodedVertexBytes;  //Followed by the vertices and indices, each padded to 4 bytes. Both are 0 for uncompressed entries
+    uint32_t encodedIndexBytes;
+};
+
+//Read-only view of a whole file, which is paged in lazily by the OS
+class MappedFile {
+public:
+    MappedFile(const std::string &filePath) {
+#ifdef WIN32
+        file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+            return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+            return;
+        data = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        size = data ? (size_t)fileSize.QuadPart : 0;
+#else
+        descriptor = open(filePath.c_str(), O_RDONLY);
+        if (descriptor < 0)
+            return;
+        struct stat status;
+        if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+            return;
+        void *address = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (address == MAP_FAILED)
+            return;
+        data = (const unsigned char *)address;
+        size = (size_t)status.st_size;
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef WIN32
+        if (data)
+            UnmapViewOfFile(data);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+#else
+        if (data)
+            munmap((void *)data, size);
+        if (descriptor >= 0)
+            close(descriptor);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+public:
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+
+private:
+#ifdef WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int descriptor = -1;
+#endif
+};
+
+//Sequential reads with bounds checks, since cache files might be truncated
+struct CacheReader {
+    const unsigned char *data;
+    size_t size, offset = 0;
+
+    bool read(void *destination, const size_t &bytes) {
+        const unsigned char *source = skip(bytes);
+        if (!source)
+            return false;
+        std::memcpy(destination, source, bytes);
+        return true;
+    }
+
+    const unsigned char *skip(const size_t &bytes) {
+        if (bytes > size - offset)
+            return nullptr;
+        offset += bytes;
+        return data + offset - bytes;
+    }
+};
+
+inline size_t getPadding(const size_t &bytes) {
+    return (4 - bytes % 4) % 4;
+}
+
+inline std::vector<unsigned char> encodeVertices(const std::vector<Model::Mesh::Vertex> &vertices) {
+    std::vector<unsigned char> buffer(meshopt_encodeVertexBufferBound(vertices.size(), sizeof(Model::Mesh::Vertex)));
+    buffer.resize(meshopt_encodeVertexBuffer(buffer.data(), buffer.size(), vertices.data(), vertices.size(), sizeof(Model::Mesh::Vertex)));
+    return buffer;
+}
+
+inline std::vector<unsigned char> encodeIndices(const std::vector<uint> &indices, const size_t &numberOfVertices) {
+    std::vector<unsigned char> buffer(meshopt_encodeIndexBufferBound(indices.size(), numberOfVertices));
+    buffer.resize(meshopt_encodeIndexBuffer(buffer.data(), buffer.size(), indices.data(), indices.size()));
+    return buffer;
+}
+
+inline bool decodeVertices(std::vector<Model::Mesh::Vertex> &vertices, const unsigned char *buffer, const size_t &bytes) {
+    return buffer && meshopt_decodeVertexBuffer(vertices.data(), vertices.size(), sizeof(Model::Mesh::Vertex), buffer, bytes) == 0;
+}
+
+inline bool decodeIndices(std::vector<uint> &indices, const unsigned char *buffer, const size_t &bytes) {
+    return buffer && meshopt_decodeIndexBuffer(indices.data(), indices.size(), sizeof(uint), buffer, bytes) == 0;
+}
+
+inline bool haveSameTriangles(const std::vector<uint> &a, const std::vector<uint> &b) {
+    //The index codec keeps the order and winding of the triangles, but may rotate the vertices within a triangle
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i + 2 < a.size(); i += 3) {
+        bool isSame = false;
+        for (size_t rotation = 0; rotation < 3 && !isSame; rotation++)
+            isSame = a[i] == b[i + rotation] && a[i + 1] == b[i + (rotation + 1) % 3] && a[i + 2] == b[i + (rotation + 2) % 3];
+        if (!isSame)
+            return false;
+    }
+    return true;
+}
+
+inline uint64_t hashBytes(const unsigned char *data, const size_t &size) {
+    //FNV-1a, which is the same on every platform
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    return hash;
+}
+
+inline uint64_t hashContent(const std::string &filePath) {
+    const MappedFile file(filePath);
+    return hashBytes(file.data, file.size);
+}
+
+inline bool getSourceInfo(const std::string &filePath, int64_t &time, uint64_t &size) {
+    std::error_code error;
+    const auto lastWriteTime = std::filesystem::last_write_time(filePath, error);
+    if (error)
+        return false;
+    size = (uint64_t)std::filesystem::file_size(filePath, error);
+    if (error)
+        return false;
+    time = (int64_t)lastWriteTime.time_since_epoch().count();
+    return true;
+}
+
+std::optional<Model::Data> MeshCache::read(const std::string &filePath, const uint &loadFlags) {
+    if (!enabled)
+        return std::nullopt;
+    const MappedFile file(getCacheFilePath(filePath));
+    if (!file.data)
+        return std::nullopt;
+    CacheReader reader = {file.data, file.size};
+
+    //--- Check whether the entry belongs to the current source file and format
+    CacheHeader header;
+    if (!reader.read(&header, sizeof(CacheHeader)) || std::memcmp(header.magic, cacheMagic, 4) != 0 || header.version != cacheVersion ||
+        header.loadFlags != loadFlags || header.vertexSize != sizeof(Model::Mesh::Vertex))
+        return std::nullopt;
+    int64_t sourceTime;
+    uint64_t sourceSize;
+    if (!getSourceInfo(filePath, sourceTime, sourceSize) || sourceSize != header.sourceSize)
+        return std::nullopt;
+    if (sourceTime != header.sourceTime && hashContent(filePath) != header.sourceHash)
+        return std::nullopt;
+
+    //--- Materials
+    Model::Data data;
+    for (uint32_t i = 0; i < header.numberOfMaterials; i++) {
+        CacheMaterial cacheMaterial;
+        if (!reader.read(&cacheMaterial, sizeof(CacheMaterial)))
+            return std::nullopt;
+        std::string texturePath(cacheMaterial.texturePathLength, '\0');
+        char padding[4];
+        if (!reader.read(texturePath.data(), texturePath.size()) || !reader.read(padding, getPadding(texturePath.size())))
+            return std::nullopt;
+
+        Model::Mesh::Material material;
+        material.ambient = cacheMaterial.ambient;
+        material.diffuse = cacheMaterial.diffuse;
+        material.specular = cacheMaterial.specular;
+        material.worldTexCoords = cacheMaterial.worldTexCoords != 0;
+        data.materials.push_back(material);
+        data.images.push_back(texturePath.empty() ? std::nullopt : std::optional<Model::Data::Image>(Model::Data::Image{texturePath}));
+    }
+
+    //--- Parts (copied or decoded out of the mapping, since meshes keep their data in memory)
+    for (uint32_t i = 0; i < header.numberOfParts; i++) {
+        CachePart cachePart;
+        if (!reader.read(&cachePart, sizeof(CachePart)) || cachePart.materialIndex < -1 ||
+            cachePart.materialIndex >= (int32_t)header.numberOfMaterials)
+            return std::nullopt;
+        Model::Data::Part &part = data.parts.emplace_back();
+        part.materialIndex = cachePart.materialIndex;
+
+        //Counts are only trusted once they fit into the file, such that corrupt entries cannot trigger huge allocations
+        const uint64_t vertexBytes = (uint64_t)cachePart.numberOfVertices * sizeof(Model::Mesh::Vertex);
+        const uint64_t indexBytes = (uint64_t)cachePart.numberOfIndices * sizeof(uint);
+        if (header.isCompressed) {
+            const unsigned char *encodedVertices = reader.skip(cachePart.encodedVertexBytes + getPadding(cachePart.encodedVertexBytes));
+            const unsigned char *encodedIndices = reader.skip(cachePart.encodedIndexBytes + getPadding(cachePart.encodedIndexBytes));
+            if (!encodedVertices || !encodedIndices || vertexBytes > maxCodecRatio * cachePart.encodedVertexBytes ||
+                indexBytes > maxCodecRatio * cachePart.encodedIndexBytes)
+                return std::nullopt;
+            part.vertices.resize(cachePart.numberOfVertices);
+            part.indices.resize(cachePart.numberOfIndices);
+            if (!decodeVertices(part.vertices, encodedVertices, cachePart.encodedVertexBytes) ||
+                !decodeIndices(part.indices, encodedIndices, cachePart.encodedIndexBytes))
+                return std::nullopt;
+        } else {
+            if (vertexBytes + indexBytes > reader.size - reader.offset)
+                return std::nullopt;
+            part.vertices.resize(cachePart.numberOfVertices);
+            part.indices.resize(cachePart.numberOfIndices);
+            if (!reader.read(part.vertices.data(), vertexBytes) || !reader.read(part.indices.data(), indexBytes))
+                return std::nullopt;
+        }
+
+        //Meshes index into their vertices without further checks
+        for (const uint &index : part.indices)
+            if (index >= cachePart.numberOfVertices)
+                return std::nullopt;
+    }
+    return data;
+}
+
+void MeshCache::write(const std::string &filePath, const uint &loadFlags, const Model::Data &data) {
+    if (!enabled)
+        return;
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, 4);
+    header.version = cacheVersion;
+    header.loadFlags = loadFlags;
+    header.vertexSize = sizeof(Model::Mesh::Vertex);
+    if (!getSourceInfo(filePath, header.sourceTime, header.sourceSize))
+        return;
+    header.sourceHash = hashContent(filePath);
+    header.numberOfMaterials = (uint32_t)data.materials.size();
+    header.numberOfParts = (uint32_t)data.parts.size();
+    header.isCompressed = (uint32_t)compress;
+    header.padding = 0;
+
+    //Write into a file of this thread first, such that readers never see a partial entry
+    const std::string cacheFilePath = getCacheFilePath(filePath);
+    std::stringstream threadID;
+    threadID << std::this_thread::get_id();
+    const std::string temporaryFilePath = cacheFilePath + "." + threadID.str() + ".tmp";
+    std::error_code error;
+    std::filesystem::create_directories(folder, error);
+    std::ofstream stream(temporaryFilePath, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        LENNY_LOG_WARNING("Could not write mesh cache file `%s`", temporaryFilePath.c_str());
+        return;
+    }
+
+    stream.write((const char *)&header, sizeof(CacheHeader));
+    for (size_t i = 0; i < data.materials.size(); i++) {
+        const Model::Mesh::Material &material = data.materials[i];
+        const std::string texturePath = data.images[i].has_value() ? data.images[i]->filePath : std::string();
+        const CacheMaterial cacheMaterial = {material.ambient, material.diffuse, material.specular, (uint32_t)material.worldTexCoords,
+                                             (uint32_t)texturePath.size()};
+        const char padding[4] = {0, 0, 0, 0};
+        stream.write((const char *)&cacheMaterial, sizeof(CacheMaterial));
+        stream.write(texturePath.data(), texturePath.size());
+        stream.write(padding, getPadding(texturePath.size()));
+    }
+    for (const Model::Data::Part &part : data.parts) {
+        CachePart cachePart = {(uint32_t)part.vertices.size(), (uint32_t)part.indices.size(), (int32_t)part.materialIndex, 0, 0};
+        if (compress) {
+            const std::vector<unsigned char> encodedVertices = encodeVertices(part.vertices);
+            const std::vector<unsigned char> encodedIndices = encodeIndices(part.indices, part.vertices.size());
+            const char padding[4] = {0, 0, 0, 0};
+            cachePart.encodedVertexBytes = (uint32_t)encodedVertices.size();
+            cachePart.encodedIndexBytes = (uint32_t)encodedIndices.size();
+            stream.write((const char *)&cachePart, sizeof(CachePart));
+            stream.write((const char *)encodedVertices.data(), encodedVertices.size());
+            stream.write(padding, getPadding(encodedVertices.size()));
+            stream.write((const char *)encodedIndices.data(), encodedIndices.size());
+            stream.write(padding, getPadding(encodedIndices.size()));
+        } else {
+            stream.write((const char *)&cachePart, sizeof(CachePart));
+            stream.write((const char *)part.vertices.data(), part.vertices.size() * sizeof(Model::Mesh::Vertex));
+            stream.write((const char *)part.indices.data(), part.indices.size() * sizeof(uint));
+        }
+    }
+    stream.close();
+
+    if (stream.fail()) {
+        std::filesystem::remove(temporaryFilePath, error);
+        LENNY_LOG_WARNING("Could not write mesh cache file `%s`", temporaryFilePath.c_str());
+        return;
+    }
+    std::filesystem::rename(temporaryFilePath, cacheFilePath, error);
+    if (error)
+        std::filesystem::remove(temporaryFilePath, error);
+}
+
+MeshCache::CodecBenchmark MeshCache::benchmarkCodec(const Model &model) {
+    CodecBenchmark benchmark;
+    tools::Timer timer;
+    for (const Model::Mesh &mesh : model.meshes) {
+        const std::vector<Model::Mesh::Vertex> &vertices = mesh.getVertices();
+        const std::vector<uint> &indices = mesh.getIndices();
+        benchmark.rawBytes += vertices.size() * sizeof(Model::Mesh::Vertex) + indices.size() * sizeof(uint);
+
+        timer.restart();
+        const std::vector<unsigned char> encodedVertices = encodeVertices(vertices);
+        const std::vector<unsigned char> encodedIndices = encodeIndices(indices, vertices.size());
+        benchmark.encodeSeconds += timer.time();
+        benchmark.encodedBytes += encodedVertices.size() + encodedIndices.size();
+
+        //Allocations are not part of the decoding
+        std::vector<Model::Mesh::Vertex> decodedVertices(vertices.size());
+        std::vector<uint> decodedIndices(indices.size());
+        timer.restart();
+        const bool isDecoded = decodeVertices(decodedVertices, encodedVertices.data(), encodedVertices.size()) &&
+                               decodeIndices(decodedIndices, encodedIndices.data(), encodedIndices.size());
+        benchmark.decodeSeconds += timer.time();
+        if (!isDecoded || decodedVertices != vertices || !haveSameTriangles(decodedIndices, indices))
+            LENNY_LOG_WARNING("Mesh of `%s` does not survive encoding", model.filePath.c_str());
+    }
+    return benchmark;
+}
+
+std::string MeshCache::getCacheFilePath(const std::string &filePath) {
+    //One entry per absolute source path
+    std::error_code error;
+    const std::filesystem::path sourcePath = std::filesystem::absolute(filePath, error).lexically_normal();
+    const std::string key = sourcePath.generic_string();
+    std::stringstream name;
+    name << std::hex << hashBytes((const unsigned char *)key.data(), key.size()) << "-" << sourcePath.filename().string() << ".mesh";
+    return folder + "/" + name.str();
+}
+
+}  // namespace lenny::gui
@@ -1,5 +1,10 @@
 #include <glad/glad.h>
+#include <lenny/gui/AssetCache.h>
+#include <lenny/gui/BVH.h>
+#include <lenny/gui/Frustum.h>
+#include <lenny/gui/MeshCache.h>
 #include <lenny/gui/Model.h>
+#include <lenny/gui/RenderQueue.h>
 #include <lenny/gui/Shaders.h>
 #include <lenny/gui/Utils.h>
 #include <lenny/tools/Utils.h>
@@ -15,7 +20,8 @@
 #include <assimp/Exporter.hpp>
 #include <assimp/Importer.hpp>
 #include <glm/gtx/hash.hpp>
-#include <glm/gtx/intersect.hpp>
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 
 namespace std {
@@ -29,6 +35,51 @@ struct hash<lenny::gui::Model::Mesh::Vertex> {
 
 namespace lenny::gui {
 
+Model::Statistics Model::statistics = {};
+Model::PackingStatistics Model::packingStatistics = {};
+tools::Model::F_loadModel Model::f_loadModel = [](tools::Model::UPtr &model, const std::string &filePath) -> void {
+    model = std::make_unique<AssetCache::Reference>(AssetCache::get(filePath));
+};
+static std::mutex bvhMutex;  //Guards the lazy construction of all BVHs, queries of built ones do not take it
+
+//Uniform handles, resolved once per shader
+static const Shader::Uniform<int> textureDiffuseUniform("texture_diffuse");
+static const Shader::Uniform<glm::vec3> objectColorUniform("objectColor");
+static const Shader::Uniform<float> objectAlphaUniform("objectAlpha");
+static const Shader::Uniform<glm::mat4> modelPoseUniform("modelPose");
+static const Shader::Uniform<glm::mat3> normalMatrixUniform("normalMatrix");
+static const Shader::Uniform<bool> usePrecomputedNormalMatrixUniform("usePrecomputedNormalMatrix");
+static const Shader::Uniform<uint> objectIDUniform("objectID");
+static const Shader::Uniform<glm::vec3> materialAmbientUniform("material.ambient");
+static const Shader::Uniform<glm::vec3> materialDiffuseUniform("material.diffuse");
+static const Shader::Uniform<glm::vec3> materialSpecularUniform("material.specular");
+static const Shader::Uniform<glm::vec3> positionOffsetUniform("positionOffset");
+static const Shader::Uniform<glm::vec3> positionScaleUniform("positionScale");
+
+inline glm::vec3 getPositionScale(const Model::Mesh::Bounds &bounds) {
+    //Flat axes get any non-zero scale, all positions are quantized to zero there
+    const glm::vec3 extent = bounds.max - bounds.min;
+    return glm::vec3(extent.x > 0.f ? extent.x : 1.f, extent.y > 0.f ? extent.y : 1.f, extent.z > 0.f ? extent.z : 1.f);
+}
+
+inline std::array<int16_t, 2> encodeOctahedral(const glm::vec3 &normal) {
+    //Project onto the octahedron, and fold the lower half over the upper one
+    const float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (sum <= 0.f)
+        return {0, 0};
+    float x = normal.x / sum, y = normal.y / sum;
+    if (normal.z < 0.f) {
+        const float folded = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+        y = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+        x = folded;
+    }
+    return {(int16_t)meshopt_quantizeSnorm(x, 16), (int16_t)meshopt_quantizeSnorm(y, 16)};
+}
+
+Model::Instance::Instance(const glm::mat4 &pose, const glm::vec4 &color) : pose(pose), normalMatrix(utils::getGLMNormalMatrix(pose)), color(color) {}
+
+//--------------------------------------------------------------------------------------------------
+
 Model::Mesh::Mesh(const std::vector<Vertex> &vertices, const std::vector<uint> &indices) : vertices(vertices), indices(indices) {
     setup();
 }
@@ -38,32 +89,196 @@ Model::Mesh::Mesh(const std::vector<Vertex> &vertices, const std::vector<uint> &
     setup();
 }
 
-void Model::Mesh::draw(const std::optional<Eigen::Vector3d> &color) const {
+Model::Mesh::Mesh(const std::vector<Vertex> &vertices, const std::vector<uint> &indices, const std::optional<Material> &material,
+                  const std::vector<uint> &lodIndices, const std::vector<LOD> &lods)
+    : vertices(vertices), indices(indices), lodIndices(lodIndices), lods(lods), material(material) {
+    setup();
+}
+
+Model::Mesh::Mesh(const Mesh &other)
+    : vertices(other.vertices), indices(other.indices), lodIndices(other.lodIndices), lods(other.lods), material(other.material), isPacked(other.isPacked) {
+    setup();
+}
+
+Model::Mesh &Model::Mesh::operator=(const Mesh &other) {
+    if (this != &other) {
+        vertices = other.vertices;
+        indices = other.indices;
+        lodIndices = other.lodIndices;
+        lods = other.lods;
+        material = other.material;
+        isPacked = other.isPacked;
+        instanceVBO.reset();
+        setup();
+    }
+    return *this;
+}
+
+void Model::Mesh::draw(const std::optional<Eigen::Vector3d> &color, const uint &lod) const {
     //Update shader uniforms based on preferences
-    Shaders::activeShader->setBool("useTexture", false);
-    Shaders::activeShader->setBool("useMaterial", false);
     if (color.has_value()) {  //Use color
-        Shaders::activeShader->setVec3("objectColor", utils::toGLM(color.value()));
-    } else if (material.has_value() && material->texture_diffuse.has_value()) {                   //Use texture
-        Shaders::activeShader->setBool("useTexture", true);                                       //Choose first texture from list
-        glActiveTexture(GL_TEXTURE0);                                                             //Active proper texture unit before binding
-        glUniform1i(glGetUniformLocation(Shaders::activeShader->getID(), "texture_diffuse"), 0);  //Set the sampler to the correct texture unit
-        glBindTexture(GL_TEXTURE_2D, material->texture_diffuse.value());                          //Bind the texture
-    } else if (material.has_value()) {                                                            //Use material
-        Shaders::activeShader->setBool("useMaterial", true);
-        Shaders::activeShader->setVec3("material.ambient", material.value().ambient);
-        Shaders::activeShader->setVec3("material.diffuse", material.value().diffuse);
-        Shaders::activeShader->setVec3("material.specular", material.value().specular);
+        Shaders::activeShader->set(objectColorUniform, utils::toGLM(color.value()));
+    } else if (material.has_value() && material->texture_diffuse) {              //Use texture
+        glActiveTexture(GL_TEXTURE0);                                            //Active proper texture unit before binding
+        Shaders::activeShader->set(textureDiffuseUniform, 0);                    //Set the sampler to the correct texture unit
+        glBindTexture(GL_TEXTURE_2D, material->texture_diffuse->getID());        //Bind the texture
+    } else if (material.has_value()) {                                           //Use material
+        Shaders::activeShader->set(materialAmbientUniform, material.value().ambient);
+        Shaders::activeShader->set(materialDiffuseUniform, material.value().diffuse);
+        Shaders::activeShader->set(materialSpecularUniform, material.value().specular);
     } else {  //Use default
-        Shaders::activeShader->setVec3("objectColor", utils::toGLM(Eigen::Vector3d::Ones()));
+        Shaders::activeShader->set(objectColorUniform, glm::vec3(1.f));
+    }
+    setLayoutUniforms();
+
+    //Draw mesh (levels of detail are stored behind the full mesh)
+    const uint indexOffset = lod > 0 ? lods.at(lod - 1).indexOffset : 0;
+    const uint indexCount = lod > 0 ? lods.at(lod - 1).indexCount : (uint)indices.size();
+    glBindVertexArray(VAO.getID());
+    glDrawElements(GL_TRIANGLES, (GLsizei)indexCount, GL_UNSIGNED_INT, (void *)(indexOffset * sizeof(uint)));
+    glBindVertexArray(0);
+
+    //Update statistics
+    statistics.drawCalls++;
+    statistics.vertices += indexCount;
+}
+
+void Model::Mesh::drawInstanced(const std::vector<Instance> &instances, const uint &objectID) const {
+    if (instances.empty())
+        return;
+
+    Shaders::activeShader->set(usePrecomputedNormalMatrixUniform, usePrecomputedNormalMatrix);
+    Shaders::activeShader->set(objectIDUniform, objectID);
+    setLayoutUniforms();
+
+    //Upload instance data (re-specifying the store orphans last frame's buffer)
+    glBindVertexArray(VAO.getID());
+    if (!instanceVBO)
+        setupInstancing();
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO.getID());
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), instances.data(), GL_STREAM_DRAW);
+    instanceVBO.setBytes(instances.size() * sizeof(Instance));
+
+    //Draw all instances at once
+    glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, nullptr, (GLsizei)instances.size());
+    glBindVertexArray(0);
+
+    //Update statistics
+    statistics.drawCalls++;
+    statistics.vertices += indices.size() * instances.size();
+}
+
+void Model::Mesh::updateVertices(const std::vector<Vertex> &vertices) {
+    this->vertices = vertices;
+    computeBounds();
+    bvh.reset();
+    builtBVH = nullptr;
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.getID());
+    uploadVertices(GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    //The levels of detail were simplified from the previous geometry, so only the full mesh stays in the element buffer
+    if (!lods.empty()) {
+        lodIndices.clear();
+        lods.clear();
+        glBindVertexArray(VAO.getID());
+        uploadIndices(GL_STATIC_DRAW);
+        glBindVertexArray(0);
     }
+}
 
-    //Draw mesh
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, nullptr);
+void Model::Mesh::updateIndices(const std::vector<uint> &indices) {
+    this->indices = indices;
+    lodIndices.clear();
+    lods.clear();
+    bvh.reset();
+    builtBVH = nullptr;
+
+    //The element buffer binding is part of the vertex array state
+    glBindVertexArray(VAO.getID());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.getID());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint), nullptr, GL_DYNAMIC_DRAW);
+    EBO.setBytes(indices.size() * sizeof(uint));
+    if (indices.size() > 0)
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(uint), &indices[0]);
     glBindVertexArray(0);
 }
 
+void Model::Mesh::generateLODs(const std::vector<float> &ratios) {
+    computeLODs(vertices, indices, ratios, lodIndices, lods);
+    if (indices.empty())
+        return;
+
+    glBindVertexArray(VAO.getID());
+    uploadIndices(GL_STATIC_DRAW);
+    glBindVertexArray(0);
+}
+
+void Model::Mesh::computeLODs(const std::vector<Vertex> &vertices, const std::vector<uint> &indices, const std::vector<float> &ratios,
+                              std::vector<uint> &lodIndices, std::vector<LOD> &lods) {
+    lodIndices.clear();
+    lods.clear();
+    if (indices.empty())
+        return;
+
+    //Simplify the full mesh for every level, the error is limited by the selection instead
+    const float scale = meshopt_simplifyScale(&vertices[0].position.x, vertices.size(), sizeof(Vertex));
+    std::vector<uint> simplified(indices.size());
+    size_t previousCount = indices.size();
+    for (const float &ratio : ratios) {
+        const size_t targetCount = size_t(ratio * (float)indices.size()) / 3 * 3;
+        float error = 0.f;
+        const size_t count = meshopt_simplify(simplified.data(), indices.data(), indices.size(), &vertices[0].position.x, vertices.size(), sizeof(Vertex),
+                                              targetCount, 1.f, 0, &error);
+        if (count == 0 || (float)count > 0.9f * (float)previousCount)
+            continue;
+        meshopt_optimizeVertexCache(simplified.data(), simplified.data(), count, vertices.size());
+
+        lods.push_back({(uint)(indices.size() + lodIndices.size()), (uint)count, error * scale});
+        lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.begin() + count);
+        previousCount = count;
+    }
+}
+
+uint Model::Mesh::selectLOD(const glm::mat4 &pose) const {
+    if (lods.empty() || !useLODs || !view)
+        return 0;
+
+    //Distance between camera and bounding sphere
+    const glm::mat3 linear(pose);
+    const float scale = std::sqrt(std::max({glm::dot(linear[0], linear[0]), glm::dot(linear[1], linear[1]), glm::dot(linear[2], linear[2])}));
+    const glm::vec3 center = glm::vec3(pose * glm::vec4(bounds.center, 1.f));
+    const float distance = glm::length(center - view->position) - scale * bounds.radius;
+    if (distance <= 0.f)
+        return 0;
+
+    //Projected error of the levels, from coarse to fine
+    const float pixelsPerError = scale * view->pixelsPerUnit / distance;
+    for (uint lod = (uint)lods.size(); lod > 0; lod--)
+        if (lods.at(lod - 1).error * pixelsPerError <= lodPixelError)
+            return lod;
+    return 0;
+}
+
+uint Model::Mesh::getNumberOfLODs() const {
+    return (uint)lods.size() + 1;
+}
+
+uint Model::Mesh::getVariant(const std::optional<Eigen::Vector3d> &color) const {
+    if (color.has_value())
+        return Shaders::COLOR | getLayoutVariant();
+    if (material.has_value() && material->texture_diffuse)
+        return (material->worldTexCoords ? Shaders::TEXTURE | Shaders::WORLD_TEXCOORDS : Shaders::TEXTURE) | getLayoutVariant();
+    if (material.has_value())
+        return Shaders::MATERIAL | getLayoutVariant();
+    return Shaders::COLOR | getLayoutVariant();
+}
+
+uint Model::Mesh::getLayoutVariant() const {
+    return isPacked ? Shaders::PACKED : 0;
+}
+
 const std::vector<Model::Mesh::Vertex> &Model::Mesh::getVertices() const {
     return vertices;
 }
@@ -76,24 +291,81 @@ const std::optional<Model::Mesh::Material> &Model::Mesh::getMaterial() const {
     return material;
 }
 
+const Model::Mesh::Bounds &Model::Mesh::getBounds() const {
+    return bounds;
+}
+
+const BVH &Model::Mesh::getBVH() const {
+    //Rays cast in parallel only contend for the lock while the tree is being built
+    if (const BVH *built = std::atomic_ref<const BVH *>(builtBVH).load(std::memory_order_acquire))
+        return *built;
+
+    std::lock_guard<std::mutex> lock(bvhMutex);
+    if (!bvh) {
+        std::vector<BVH::Triangle> triangles(indices.size() / 3);
+        for (size_t i = 0; i < triangles.size(); i++)
+            for (int j = 0; j < 3; j++)
+                triangles[i][j] = vertices[indices[3 * i + j]].position;
+        bvh = std::make_shared<const BVH>(triangles);
+        std::atomic_ref<const BVH *>(builtBVH).store(bvh.get(), std::memory_order_release);
+    }
+    return *bvh;
+}
+
+size_t Model::Mesh::getCPUBytes() const {
+    return vertices.size() * sizeof(Vertex) + (indices.size() + lodIndices.size()) * sizeof(uint);
+}
+
+size_t Model::Mesh::getGPUBytes() const {
+    return VBO.getBytes() + EBO.getBytes() + instanceVBO.getBytes();
+}
+
+size_t Model::Mesh::getPackingSavings() const {
+    return packingAccount.get();
+}
+
 void Model::Mesh::setup() {
-    //Create buffers/arrays
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+    computeBounds();
+    bvh.reset();
+    builtBVH = nullptr;
+
+    //Create buffers/arrays (replaces previous ones)
+    VAO = GLVertexArray::create();
+    VBO = GLBuffer::create();
+    EBO = GLBuffer::create();
 
     //Bind and load data
-    glBindVertexArray(VAO);
+    glBindVertexArray(VAO.getID());
 
-    //Update vertices and indices info
-    if (vertices.size() > 0) {
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-    }
+    //Update vertices and indices info (buffers are bound in any case, such that they can be filled by an update later)
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.getID());
+    if (vertices.size() > 0)
+        uploadVertices(GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.getID());
+    if (indices.size() > 0)
+        uploadIndices(GL_STATIC_DRAW);
+
+    //Set the vertex attribute pointers
+    setupVertexAttributes();
+
+    //Unbind array
+    glBindVertexArray(0);
+}
 
-    if (indices.size() > 0) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint), &indices[0], GL_STATIC_DRAW);
+void Model::Mesh::setupVertexAttributes() const {
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.getID());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.getID());
+
+    //Packed attributes are normalized to floats by GL, the shader maps them back (see `PackedVertex`)
+    if (isPacked) {
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, texCoords));
+        return;
     }
 
     //Set the vertex attribute pointers for ...
@@ -108,9 +380,91 @@ void Model::Mesh::setup() {
     //... texture coordinates
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoords));
+}
 
-    //Unbind array
-    glBindVertexArray(0);
+void Model::Mesh::setLayoutUniforms() const {
+    if (!isPacked)
+        return;
+    Shaders::activeShader->set(positionOffsetUniform, bounds.min);
+    Shaders::activeShader->set(positionScaleUniform, getPositionScale(bounds));
+}
+
+void Model::Mesh::setupInstancing() const {
+    //Expects the vertex array of this mesh to be bound
+    instanceVBO = GLBuffer::create();
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO.getID());
+
+    //... pose (a mat4 occupies four consecutive attribute locations)
+    for (uint i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(3 + i);
+        glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *)(offsetof(Instance, pose) + i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + i, 1);
+    }
+
+    //... normal matrix (a mat3 occupies three consecutive attribute locations)
+    for (uint i = 0; i < 3; i++) {
+        glEnableVertexAttribArray(7 + i);
+        glVertexAttribPointer(7 + i, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *)(offsetof(Instance, normalMatrix) + i * sizeof(glm::vec3)));
+        glVertexAttribDivisor(7 + i, 1);
+    }
+
+    //... color
+    glEnableVertexAttribArray(10);
+    glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *)offsetof(Instance, color));
+    glVertexAttribDivisor(10, 1);
+}
+
+void Model::Mesh::uploadVertices(const uint &usage) {
+    //Expects the vertex buffer of this mesh to be bound. Re-specifying the store orphans the old one, such that the driver does not need to wait for
+    //pending draws reading from it
+    if (!isPacked) {
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), usage);
+        VBO.setBytes(vertices.size() * sizeof(Vertex));
+        packingAccount.set(0);
+        return;
+    }
+
+    //Quantize relative to the current bounds, which are passed to the shader with every draw
+    static std::vector<PackedVertex> packed;  //Reused to avoid allocations
+    packed.resize(vertices.size());
+    const glm::vec3 scale = getPositionScale(bounds);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const Vertex &vertex = vertices[i];
+        for (int j = 0; j < 3; j++)
+            packed[i].position[j] = (uint16_t)meshopt_quantizeUnorm((vertex.position[j] - bounds.min[j]) / scale[j], 16);
+        packed[i].position[3] = 0;
+        packed[i].normal = encodeOctahedral(vertex.normal);
+        packed[i].texCoords = {meshopt_quantizeHalf(vertex.texCoords[0]), meshopt_quantizeHalf(vertex.texCoords[1])};
+    }
+    glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), usage);
+    VBO.setBytes(packed.size() * sizeof(PackedVertex));
+    packingAccount.set(vertices.size() * (sizeof(Vertex) - sizeof(PackedVertex)));
+}
+
+void Model::Mesh::uploadIndices(const uint &usage) {
+    //Expects the vertex array of this mesh to be bound
+    const size_t size = (indices.size() + lodIndices.size()) * sizeof(uint);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.getID());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, nullptr, usage);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(uint), indices.data());
+    if (!lodIndices.empty())
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint), lodIndices.size() * sizeof(uint), lodIndices.data());
+    EBO.setBytes(size);
+}
+
+void Model::Mesh::computeBounds() {
+    bounds = Bounds();
+    if (vertices.empty())
+        return;
+
+    bounds.min = bounds.max = vertices[0].position;
+    for (const Vertex &vertex : vertices) {
+        bounds.min = glm::min(bounds.min, vertex.position);
+        bounds.max = glm::max(bounds.max, vertex.position);
+    }
+    bounds.center = 0.5f * (bounds.min + bounds.max);
+    for (const Vertex &vertex : vertices)
+        bounds.radius = std::max(bounds.radius, glm::length(vertex.position - bounds.center));
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -121,16 +475,75 @@ Model::Model(const std::string &filePath) : tools::Model(filePath) {
     load(filePath);
 }
 
+Model::Model(const std::string &filePath, std::vector<Mesh> &&meshes) : tools::Model(filePath), meshes(std::move(meshes)) {}
+
 void Model::draw(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation, const Eigen::Vector3d &scale,
                  const std::optional<Eigen::Vector3d> &color, const double &alpha) const {
-    Shaders::activeShader->activate();
-    Shaders::activeShader->setMat4("modelPose", utils::getGLMTransform(position, orientation, scale));
-    Shaders::activeShader->setFloat("objectAlpha", (float)alpha);
-    for (const Mesh &mesh : meshes)
-        mesh.draw(color);
+    const glm::mat4 pose = utils::getGLMTransform(position, orientation, scale);
+    const glm::mat3 normalMatrix = utils::getGLMNormalMatrix(pose);
+
+    if (RenderQueue::current) {
+        //Record meshes, the queue sorts them across all models of the scene
+        for (const Mesh &mesh : meshes)
+            if (!Frustum::current || Frustum::current->isVisible(mesh.getBounds(), pose))
+                RenderQueue::current->add(mesh, pose, normalMatrix, color, (float)alpha, mesh.selectLOD(pose));
+    } else {
+        //Draw meshes grouped by shader variant (all non-instanced ones, for both vertex layouts), such that every variant is bound at most once
+        for (uint i = 0; i < 2 * Shaders::INSTANCED; i++) {
+            const uint variant = (i & (Shaders::INSTANCED - 1)) | (i >= Shaders::INSTANCED ? Shaders::PACKED : 0);
+            bool isBound = false;
+            for (const Mesh &mesh : meshes) {
+                if (mesh.getVariant(color) != variant)
+                    continue;
+                if (Frustum::current && !Frustum::current->isVisible(mesh.getBounds(), pose))
+                    continue;
+                if (!isBound) {
+                    Shaders::useVariant(variant);
+                    setUniforms(pose, normalMatrix, (float)alpha, objectID);
+                    isBound = true;
+                }
+                mesh.draw(color, mesh.selectLOD(pose));
+            }
+        }
+    }
     tools::Model::draw(position, orientation, scale, color, alpha);
 }
 
+void Model::drawInstanced(const std::vector<Instance> &instances) const {
+    if (instances.empty())
+        return;
+
+    //Instances carry their own color, so materials and textures are ignored
+    static std::vector<Instance> visibleInstances;  //Reused to avoid allocations
+    for (const Mesh &mesh : meshes) {
+        const std::vector<Instance> *meshInstances = &instances;
+        if (Frustum::current) {
+            Frustum::current->cull(mesh.getBounds(), instances, visibleInstances);
+            meshInstances = &visibleInstances;
+        }
+
+        if (RenderQueue::current) {
+            RenderQueue::current->addInstanced(mesh, *meshInstances);
+        } else {
+            Shaders::useVariant(Shaders::INSTANCED | mesh.getLayoutVariant());
+            mesh.drawInstanced(*meshInstances, objectID);
+        }
+    }
+}
+
+void Model::generateLODs(const std::vector<float> &ratios) {
+    for (Mesh &mesh : meshes)
+        mesh.generateLODs(ratios);
+}
+
+void Model::setUniforms(const glm::mat4 &pose, const glm::mat3 &normalMatrix, const float &alpha, const uint &objectID) {
+    Shaders::activeShader->set(modelPoseUniform, pose);
+    Shaders::activeShader->set(normalMatrixUniform, normalMatrix);
+    Shaders::activeShader->set(usePrecomputedNormalMatrixUniform, usePrecomputedNormalMatrix);
+    Shaders::activeShader->set(objectAlphaUniform, alpha);
+    Shaders::activeShader->set(objectIDUniform, objectID);
+}
+
 std::optional<Model::HitInfo> Model::hitByRay(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation, const Eigen::Vector3d &scale,
                                               const Ray &ray) const {
     const glm::vec3 orig = utils::toGLM(ray.origin);
@@ -149,29 +562,26 @@ std::optional<Model::HitInfo> Model::hitByRay(const Eigen::Vector3d &position, c
         const auto& vertices = mesh.getVertices();
         const auto& indices = mesh.getIndices();
 
-        for (uint i = 0; i < indices.size() / 3; ++i) {
-            glm::vec3 v0 = vertices[indices[3 * i + 0]].position;
-            glm::vec3 v1 = vertices[indices[3 * i + 1]].position;
-            glm::vec3 v2 = vertices[indices[3 * i + 2]].position;
-
-            float t_ = 0.f;
-            glm::vec2 bary;
-            const bool tHit = glm::intersectRayTriangle(origModel, dirModel, v0, v1, v2, bary, t_);
-
-            if (tHit && t_ > 1e-8 && t_ < t) {
-                hit = true;
-                t = t_;
-
-                //Handle the scaling here, otherwise the normal is a bit messed up
-                for (int idx = 0; idx < 3; idx++) {
-                    v0[idx] *= scale[idx];
-                    v1[idx] *= scale[idx];
-                    v2[idx] *= scale[idx];
-                }
-
-                hitPoint = utils::toEigen(v0 * (1 - bary.x - bary.y) + v1 * bary.x + v2 * bary.y);
-                hitNormal = utils::toEigen(v1 - v0).cross(utils::toEigen(v2 - v0)).normalized();
+        //Closest triangle of this mesh, which is closer than the ones of the previous meshes
+        const std::optional<BVH::Hit> meshHit = mesh.getBVH().intersect(origModel, dirModel, (float)t);
+        if (meshHit.has_value()) {
+            hit = true;
+            t = meshHit->t;
+
+            glm::vec3 v0 = vertices[indices[3 * meshHit->triangle + 0]].position;
+            glm::vec3 v1 = vertices[indices[3 * meshHit->triangle + 1]].position;
+            glm::vec3 v2 = vertices[indices[3 * meshHit->triangle + 2]].position;
+            const glm::vec2 &bary = meshHit->barycentric;
+
+            //Handle the scaling here, otherwise the normal is a bit messed up
+            for (int idx = 0; idx < 3; idx++) {
+                v0[idx] *= scale[idx];
+                v1[idx] *= scale[idx];
+                v2[idx] *= scale[idx];
             }
+
+            hitPoint = utils::toEigen(v0 * (1 - bary.x - bary.y) + v1 * bary.x + v2 * bary.y);
+            hitNormal = utils::toEigen(v1 - v0).cross(utils::toEigen(v2 - v0)).normalized();
         }
     }
 
@@ -184,37 +594,39 @@ std::optional<Model::HitInfo> Model::hitByRay(const Eigen::Vector3d &position, c
     return std::nullopt;
 }
 
-inline uint loadTextureFromFile(const std::string &fileName, const std::string &directory) {
-    const std::string filePath = directory + '/' + fileName;
-
-    uint textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrComponents, 0);
-    if (data) {
-        GLenum format = 0;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    } else {
-        LENNY_LOG_WARNING("Failed to load texture from path `%s`", filePath.c_str());
-    }
+inline void decodeImage(Model::Data::Image &image) {
+    unsigned char *data = stbi_load(image.filePath.c_str(), &image.width, &image.height, &image.components, 0);
+    if (data)
+        image.pixels.assign(data, data + (size_t)image.width * image.height * image.components);
+    else
+        LENNY_LOG_WARNING("Failed to load texture from path `%s`", image.filePath.c_str());
     stbi_image_free(data);
+}
 
-    return textureID;
+inline std::shared_ptr<const GLTexture> createTexture(const Model::Data::Image &image) {
+    std::shared_ptr<GLTexture> texture = std::make_shared<GLTexture>(GLTexture::create());
+    if (image.pixels.empty())
+        return texture;
+
+    GLenum format = 0;
+    if (image.components == 1)
+        format = GL_RED;
+    else if (image.components == 3)
+        format = GL_RGB;
+    else if (image.components == 4)
+        format = GL_RGBA;
+
+    glBindTexture(GL_TEXTURE_2D, texture->getID());
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    texture->setBytes((size_t)image.width * image.height * image.components * 4 / 3);  //Including mipmaps
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    return texture;
 }
 
 inline uint prepareImporter(const std::string &filePath) {
@@ -237,25 +649,68 @@ inline uint prepareImporter(const std::string &filePath) {
     return loadFlags;
 }
 
-void Model::load(const std::string &filePath) {
-    //--- Import
+std::vector<std::optional<Model::HitInfo>> Model::castRays(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation,
+                                                           const Eigen::Vector3d &scale, std::span<const Ray> rays) const {
+    //Build the BVHs up front instead of letting the threads wait for each other
+    for (const Mesh &mesh : meshes)
+        mesh.getBVH();
+
+    std::vector<std::optional<HitInfo>> hits(rays.size());
+    utils::parallelFor(rays.size(), [&](size_t begin, size_t end) -> void {
+        for (size_t i = begin; i < end; i++)
+            hits[i] = hitByRay(position, orientation, scale, rays[i]);
+    });
+    return hits;
+}
+
+void Model::load(const std::string &filePath, const bool &generateLODs) {
+    Data data = parse(filePath);
+    for (size_t i = 0; i < data.materials.size(); i++)
+        uploadMaterial(data, i);
+
+    this->meshes.clear();
+    for (size_t i = 0; i < data.parts.size(); i++)
+        this->meshes.emplace_back(uploadPart(data, i));
+
+    //--- Levels of detail
+    if (generateLODs)
+        this->generateLODs();
+}
+
+Model::Data Model::parse(const std::string &filePath) {
     const uint loadFlags = prepareImporter(filePath);
-    Assimp::Importer importer;
-    const aiScene *pScene = importer.ReadFile(filePath.c_str(), loadFlags);
-    if (!pScene)
-        LENNY_LOG_ERROR("Error in parsing file `%s`: `%s`", filePath.c_str(), importer.GetErrorString());
+    std::optional<Data> cachedData = MeshCache::read(filePath, loadFlags);
+    Data data = cachedData.has_value() ? std::move(cachedData.value()) : importFile(filePath, loadFlags);
 
     //--- Extract directory from filePath
     std::string tmpPath(filePath);
     std::replace(tmpPath.begin(), tmpPath.end(), '\\', '/');
     const std::string directory = tmpPath.substr(0, tmpPath.find_last_of('/'));
 
+    //--- Textures (relative to the file as spelled by this call, the cached data is shared by all spellings)
+    for (std::optional<Data::Image> &image : data.images) {
+        if (image.has_value()) {
+            image->filePath = directory + '/' + image->filePath;
+            decodeImage(image.value());
+        }
+    }
+    return data;
+}
+
+Model::Data Model::importFile(const std::string &filePath, const uint &loadFlags) {
+    //--- Import
+    Assimp::Importer importer;
+    const aiScene *pScene = importer.ReadFile(filePath.c_str(), loadFlags);
+    if (!pScene)
+        LENNY_LOG_ERROR("Error in parsing file `%s`: `%s`", filePath.c_str(), importer.GetErrorString());
+
     //--- Materials
-    std::vector<Mesh::Material> materials;
+    Data data;
     for (uint i = 0; i < pScene->mNumMaterials; i++) {
         const aiMaterial *pMaterial = pScene->mMaterials[i];
 
         Mesh::Material material;
+        std::optional<Data::Image> image = std::nullopt;
         aiColor3D aiC;
 
         //Ambient color
@@ -276,23 +731,24 @@ void Model::load(const std::string &filePath) {
         else
             LENNY_LOG_DEBUG("Specular material color could not be read");
 
-        //Texture
+        //Texture (as stored in the file, resolved and decoded by `parse`, created when uploading)
         if (pMaterial->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
             aiString pPath;
             if (pMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &pPath, nullptr, nullptr, nullptr, nullptr, nullptr) == AI_SUCCESS)
-                material.texture_diffuse = loadTextureFromFile(std::string(pPath.data), directory);
+                image = Data::Image{std::string(pPath.data)};
         }
 
-        materials.emplace_back(material);
+        data.materials.emplace_back(material);
+        data.images.emplace_back(std::move(image));
     }
 
     //--- Meshes
-    this->meshes.clear();
     for (uint i = 0; i < pScene->mNumMeshes; i++) {
         const aiMesh *paiMesh = pScene->mMeshes[i];
+        Data::Part part;
 
         //Vertices
-        std::vector<Mesh::Vertex> vertices;
+        std::vector<Mesh::Vertex> &vertices = part.vertices;
         for (uint j = 0; j < paiMesh->mNumVertices; j++) {
             const aiVector3D &pPos = paiMesh->mVertices[j];
 
@@ -310,7 +766,7 @@ void Model::load(const std::string &filePath) {
         }
 
         //Indices
-        std::vector<uint> indices;
+        std::vector<uint> &indices = part.indices;
         for (uint j = 0; j < paiMesh->mNumFaces; j++) {
             const aiFace &face = paiMesh->mFaces[j];
 
@@ -322,14 +778,28 @@ void Model::load(const std::string &filePath) {
                                 face.mNumIndices);
         }
 
-        //Add to meshes
+        //Add to parts
         if (vertices.size() > 0 && indices.size() > 0) {
-            if (paiMesh->mMaterialIndex < materials.size())
-                this->meshes.emplace_back(vertices, indices, materials[paiMesh->mMaterialIndex]);
-            else
-                this->meshes.emplace_back(vertices, indices);
+            if (paiMesh->mMaterialIndex < data.materials.size())
+                part.materialIndex = (int)paiMesh->mMaterialIndex;
+            data.parts.emplace_back(std::move(part));
         }
     }
+
+    //--- Store for the next time
+    MeshCache::write(filePath, loadFlags, data);
+    return data;
+}
+
+void Model::uploadMaterial(Data &data, const size_t &index) {
+    if (data.images.at(index).has_value())
+        data.materials.at(index).texture_diffuse = createTexture(data.images.at(index).value());
+}
+
+Model::Mesh Model::uploadPart(const Data &data, const size_t &index) {
+    const Data::Part &part = data.parts.at(index);
+    const std::optional<Mesh::Material> material = part.materialIndex >= 0 ? std::optional<Mesh::Material>(data.materials.at(part.materialIndex)) : std::nullopt;
+    return Mesh(part.vertices, part.indices, material, part.lodIndices, part.lods);
 }
 
 bool Model::exportAsOBJ() const {
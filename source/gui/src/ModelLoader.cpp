@@ -0,0 +1,180 @@
+#include <lenny/gui/AssetCache.h>
+#include <lenny/gui/ModelLoader.h>
+#include <lenny/gui/Renderer.h>
+#include <lenny/gui/Utils.h>
+#include <lenny/tools/Timer.h>
+
+#include <chrono>
+#include <future>
+#include <limits>
+
+namespace lenny::gui {
+
+//The worker thread writes the data and bounds, everything else belongs to the main thread
+struct ModelLoader::Load {
+    AssetCache::Key key;
+    std::shared_ptr<Model> model;
+    bool generateLODs = false;
+
+    std::future<void> parsing;
+    bool isParsed = false;  //Set once the main thread noticed the end of parsing
+    Model::Data data;
+    glm::vec3 min = glm::vec3(0.f), max = glm::vec3(0.f);  //Of all parts
+
+    size_t uploadedSteps = 0;  //Materials first, then parts
+    std::vector<Model::Mesh> meshes;
+    bool isReady = false;
+};
+
+ModelLoader::Handle::Handle(const std::shared_ptr<const Model> &model) : model(model) {}
+
+bool ModelLoader::Handle::isReady() const {
+    return model && (!load || load->isReady);
+}
+
+const std::shared_ptr<const Model> &ModelLoader::Handle::get() const {
+    return model;
+}
+
+void ModelLoader::Handle::draw(const Eigen::Vector3d &position, const Eigen::QuaternionD &orientation, const Eigen::Vector3d &scale,
+                               const std::optional<Eigen::Vector3d> &color, const double &alpha) const {
+    if (isReady()) {
+        model->draw(position, orientation, scale, color, alpha);
+        return;
+    }
+
+    const Eigen::Vector3d rgb = color.value_or(Eigen::Vector3d(0.5, 0.5, 0.5));
+    const Eigen::Vector4d placeholderColor(rgb[0], rgb[1], rgb[2], alpha);
+    if (load && load->isParsed) {
+        const Eigen::Vector3d center = scale.cwiseProduct(utils::toEigen(0.5f * (load->min + load->max)));
+        const Eigen::Vector3d dimensions = scale.cwiseProduct(utils::toEigen(load->max - load->min));
+        Renderer::drawDebugBox(position + orientation * center, orientation, dimensions, placeholderColor);
+    } else {
+        Renderer::drawDebugBox(position, orientation, Eigen::Vector3d::Constant(0.1), placeholderColor);
+    }
+}
+
+ModelLoader::Handle ModelLoader::load(const std::string &filePath, const bool &generateLODs) {
+    if (const std::shared_ptr<const Model> cached = AssetCache::find(filePath, generateLODs))
+        return Handle(cached);
+
+    //Join a pending load of the same file
+    const AssetCache::Key key = AssetCache::getKey(filePath, generateLODs);
+    std::shared_ptr<Load> load;
+    for (const std::deque<std::shared_ptr<Load>> *loads : {&waitingLoads, &activeLoads})
+        for (const std::shared_ptr<Load> &pendingLoad : *loads)
+            if (pendingLoad->key == key)
+                load = pendingLoad;
+    if (!load) {
+        load = std::make_shared<Load>();
+        load->key = key;
+        load->model = std::make_shared<Model>(filePath, std::vector<Model::Mesh>());
+        load->generateLODs = generateLODs;
+        waitingLoads.push_back(load);
+    }
+
+    Handle handle;
+    handle.model = load->model;
+    handle.load = load;
+    return handle;
+}
+
+void ModelLoader::update() {
+    //Start parsing while there is room, which bounds the memory held by parsed files waiting for their upload
+    while (!waitingLoads.empty() && activeLoads.size() < maxActiveLoads) {
+        startParsing(waitingLoads.front());
+        activeLoads.push_back(waitingLoads.front());
+        waitingLoads.pop_front();
+    }
+
+    //Upload in the order of the requests, such that the budget is not split over many models
+    tools::Timer timer;
+    bool isFirstStep = true;
+    for (auto it = activeLoads.begin(); it != activeLoads.end();) {
+        Load &load = **it;
+        if (!load.isParsed) {
+            if (load.parsing.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                it++;
+                continue;
+            }
+            load.parsing.get();  //Rethrows errors of the worker
+            load.isParsed = true;
+        }
+
+        while (load.uploadedSteps < load.data.materials.size() + load.data.parts.size()) {
+            if (!isFirstStep && timer.time() > uploadBudget)
+                return;
+            uploadStep(load);
+            isFirstStep = false;
+        }
+        finish(load);
+        it = activeLoads.erase(it);
+    }
+}
+
+std::shared_ptr<const Model> ModelLoader::await(const std::string &filePath, const bool &generateLODs) {
+    const AssetCache::Key key = AssetCache::getKey(filePath, generateLODs);
+    for (std::deque<std::shared_ptr<Load>> *loads : {&waitingLoads, &activeLoads}) {
+        for (auto it = loads->begin(); it != loads->end(); it++) {
+            const std::shared_ptr<Load> load = *it;
+            if (load->key != key)
+                continue;
+            loads->erase(it);
+
+            if (!load->parsing.valid())
+                startParsing(load);
+            if (!load->isParsed) {
+                load->parsing.get();
+                load->isParsed = true;
+            }
+            while (load->uploadedSteps < load->data.materials.size() + load->data.parts.size())
+                uploadStep(*load);
+            finish(*load);
+            return load->model;
+        }
+    }
+    return nullptr;
+}
+
+uint ModelLoader::getNumberOfPendingLoads() {
+    return (uint)(waitingLoads.size() + activeLoads.size());
+}
+
+void ModelLoader::startParsing(const std::shared_ptr<Load> &load) {
+    load->parsing = std::async(std::launch::async, [load = load.get()]() -> void {
+        load->data = Model::parse(load->model->filePath);
+        if (load->data.parts.empty())
+            return;
+        if (load->generateLODs)  //Simplification takes far too long for a step of the upload
+            for (Model::Data::Part &part : load->data.parts)
+                Model::Mesh::computeLODs(part.vertices, part.indices, {0.5f, 0.25f, 0.1f}, part.lodIndices, part.lods);
+        load->min = glm::vec3(std::numeric_limits<float>::max());
+        load->max = glm::vec3(-std::numeric_limits<float>::max());
+        for (const Model::Data::Part &part : load->data.parts) {
+            for (const Model::Mesh::Vertex &vertex : part.vertices) {
+                load->min = glm::min(load->min, vertex.position);
+                load->max = glm::max(load->max, vertex.position);
+            }
+        }
+    });
+}
+
+void ModelLoader::uploadStep(Load &load) {
+    //Materials first, such that the parts find their textures
+    const size_t numberOfMaterials = load.data.materials.size();
+    if (load.uploadedSteps < numberOfMaterials)
+        Model::uploadMaterial(load.data, load.uploadedSteps);
+    else
+        load.meshes.emplace_back(Model::uploadPart(load.data, load.uploadedSteps - numberOfMaterials));
+    load.uploadedSteps++;
+}
+
+void ModelLoader::finish(Load &load) {
+    //Hand the meshes over, share the model from now on and release the parsed data
+    load.model->meshes = std::move(load.meshes);
+    AssetCache::add(load.model, load.generateLODs);
+    load.data = Model::Data();
+    load.isReady = true;
+}
+
+}  // namespace lenny::gui
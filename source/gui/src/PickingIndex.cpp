@@ -0,0 +1,178 @@
+#include <lenny/gui/BVH.h>
+#include <lenny/gui/PickingIndex.h>
+#include <lenny/gui/Utils.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace lenny::gui {
+
+PickingIndex::Handle PickingIndex::add(const Model& model, const Eigen::Vector3d& position, const Eigen::QuaternionD& orientation,
+                                       const Eigen::Vector3d& scale) {
+    Object& object = objects.emplace_back(Object{&model, position, orientation, scale, glm::vec3(0.f), glm::vec3(0.f), true});
+    computeBounds(object);
+    needsRebuild = true;
+    return (Handle)(objects.size() - 1);
+}
+
+void PickingIndex::update(const Handle& handle, const Eigen::Vector3d& position, const Eigen::QuaternionD& orientation, const Eigen::Vector3d& scale) {
+    Object& object = objects.at(handle);
+    if (object.position == position && object.orientation.coeffs() == orientation.coeffs() && object.scale == scale)
+        return;
+    object.position = position;
+    object.orientation = orientation;
+    object.scale = scale;
+    computeBounds(object);
+    needsRefit = true;
+}
+
+void PickingIndex::remove(const Handle& handle) {
+    objects.at(handle).isActive = false;
+    needsRebuild = true;
+}
+
+void PickingIndex::clear() {
+    objects.clear();
+    nodes.clear();
+    order.clear();
+    needsRebuild = needsRefit = false;
+}
+
+std::optional<PickingIndex::Hit> PickingIndex::hitByRay(const Ray& ray) const {
+    prepare();
+    if (nodes.empty())
+        return std::nullopt;
+
+    //The ray parameter of a hit does not depend on the pose of a model, so hits of different models can be compared directly
+    const glm::vec3 origin = utils::toGLM(ray.origin);
+    const glm::vec3 inverseDirection = glm::vec3(1.f) / utils::toGLM(ray.direction);
+    std::optional<Hit> hit;
+    float tClosest = std::numeric_limits<float>::max();
+
+    BVH::traverse(nodes, depth, origin, inverseDirection, tClosest, [&](const Node& node, float& t) -> void {
+        for (uint i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+            const Object& object = objects[order[i]];
+            const std::optional<tools::Model::HitInfo> info = object.model->hitByRay(object.position, object.orientation, object.scale, ray);
+            if (info.has_value() && info->t < t) {
+                t = (float)info->t;
+                hit = Hit{order[i], info.value()};
+            }
+        }
+    });
+    return hit;
+}
+
+std::vector<std::optional<PickingIndex::Hit>> PickingIndex::castRays(std::span<const Ray> rays) const {
+    //Update the tree and build the BVHs of all meshes before the threads share them
+    prepare();
+    for (const Handle& handle : order)
+        for (const Model::Mesh& mesh : objects[handle].model->meshes)
+            mesh.getBVH();
+
+    std::vector<std::optional<Hit>> hits(rays.size());
+    utils::parallelFor(rays.size(), [&](size_t begin, size_t end) -> void {
+        for (size_t i = begin; i < end; i++)
+            hits[i] = hitByRay(rays[i]);
+    });
+    return hits;
+}
+
+void PickingIndex::prepare() const {
+    if (needsRebuild)
+        rebuild();
+    else if (needsRefit)
+        refit();
+}
+
+void PickingIndex::computeBounds(Object& object) {
+    //World box around the transformed box of every mesh
+    const glm::mat4 pose = utils::getGLMTransform(object.position, object.orientation, object.scale);
+    const glm::mat3 linear(pose);
+    object.min = glm::vec3(std::numeric_limits<float>::max());
+    object.max = glm::vec3(-std::numeric_limits<float>::max());
+    for (const Model::Mesh& mesh : object.model->meshes) {
+        const Model::Mesh::Bounds& bounds = mesh.getBounds();
+        const glm::vec3 center = glm::vec3(pose * glm::vec4(0.5f * (bounds.min + bounds.max), 1.f));
+        const glm::vec3 halfExtents = 0.5f * (bounds.max - bounds.min);
+        glm::vec3 worldHalfExtents(0.f);
+        for (int i = 0; i < 3; i++)
+            worldHalfExtents += glm::abs(linear[i]) * halfExtents[i];
+        object.min = glm::min(object.min, center - worldHalfExtents);
+        object.max = glm::max(object.max, center + worldHalfExtents);
+    }
+}
+
+void PickingIndex::rebuild() const {
+    order.clear();
+    for (Handle handle = 0; handle < objects.size(); handle++)
+        if (objects[handle].isActive && !objects[handle].model->meshes.empty())
+            order.push_back(handle);
+
+    nodes.clear();
+    if (!order.empty()) {
+        nodes.reserve(2 * order.size());
+        nodes.push_back({glm::vec3(0.f), 0, glm::vec3(0.f), (uint)order.size()});
+        depth = 0;
+        updateBounds(0);
+        subdivide(0, 0);
+    }
+    needsRebuild = needsRefit = false;
+}
+
+void PickingIndex::refit() const {
+    //Children are stored after their parents, so a reverse sweep updates them first
+    for (uint i = (uint)nodes.size(); i-- > 0;) {
+        Node& node = nodes[i];
+        if (node.count > 0) {
+            updateBounds(i);
+        } else {
+            node.min = glm::min(nodes[node.leftOrFirst].min, nodes[node.leftOrFirst + 1].min);
+            node.max = glm::max(nodes[node.leftOrFirst].max, nodes[node.leftOrFirst + 1].max);
+        }
+    }
+    needsRefit = false;
+}
+
+void PickingIndex::subdivide(const uint& nodeIndex, const uint& level) const {
+    depth = std::max(depth, level);
+    const uint first = nodes[nodeIndex].leftOrFirst, count = nodes[nodeIndex].count;
+    if (count <= 2)
+        return;
+
+    //Median split along the longest axis of the centroids, which keeps the tree balanced under refits
+    glm::vec3 centroidMin(std::numeric_limits<float>::max()), centroidMax(-std::numeric_limits<float>::max());
+    auto getCentroid = [&](const Handle& handle) -> glm::vec3 { return 0.5f * (objects[handle].min + objects[handle].max); };
+    for (uint i = first; i < first + count; i++) {
+        centroidMin = glm::min(centroidMin, getCentroid(order[i]));
+        centroidMax = glm::max(centroidMax, getCentroid(order[i]));
+    }
+    const glm::vec3 extent = centroidMax - centroidMin;
+    const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+    const uint leftCount = count / 2;
+    std::nth_element(order.begin() + first, order.begin() + first + leftCount, order.begin() + first + count,
+                     [&](const Handle& a, const Handle& b) -> bool { return getCentroid(a)[axis] < getCentroid(b)[axis]; });
+
+    //Create children (the reference into the node array is invalidated by pushing)
+    const uint leftIndex = (uint)nodes.size();
+    nodes.push_back({glm::vec3(0.f), first, glm::vec3(0.f), leftCount});
+    nodes.push_back({glm::vec3(0.f), first + leftCount, glm::vec3(0.f), count - leftCount});
+    nodes[nodeIndex].leftOrFirst = leftIndex;
+    nodes[nodeIndex].count = 0;
+    updateBounds(leftIndex);
+    updateBounds(leftIndex + 1);
+    subdivide(leftIndex, level + 1);
+    subdivide(leftIndex + 1, level + 1);
+}
+
+void PickingIndex::updateBounds(const uint& nodeIndex) const {
+    Node& node = nodes[nodeIndex];
+    node.min = glm::vec3(std::numeric_limits<float>::max());
+    node.max = glm::vec3(-std::numeric_limits<float>::max());
+    for (uint i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+        node.min = glm::min(node.min, objects[order[i]].min);
+        node.max = glm::max(node.max, objects[order[i]].max);
+    }
+}
+
+}  // namespace lenny::gui
@@ -0,0 +1,64 @@
+#include <glad/glad.h>
+#include <lenny/gui/PixelReader.h>
+
+namespace lenny::gui {
+
+PixelReader::PixelReader(const uint& format, const uint& type, const uint& attachment) : format(format), type(type), attachment(attachment) {}
+
+PixelReader::~PixelReader() {
+    if (!GLResources::contextIsAlive)
+        return;
+    for (GLsync fence : fences)
+        if (fence)
+            glDeleteSync(fence);
+}
+
+uint PixelReader::request(const int& x, const int& y) {
+    const uint slot = numberOfRequests % ringSize;
+    GLBuffer& buffer = buffers[slot];
+    if (!buffer) {
+        buffer = GLBuffer::create();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.getID());
+        glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_READ);
+        buffer.setBytes(sizeof(GLuint));
+    }
+    if (fences[slot])
+        glDeleteSync(fences[slot]);
+
+    //The copy into the buffer is queued, `glReadPixels` returns immediately
+    const bool readsColor = format != GL_DEPTH_COMPONENT && format != GL_STENCIL_INDEX;
+    if (readsColor)
+        glReadBuffer(attachment);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.getID());
+    glReadPixels(x, y, 1, 1, format, type, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (readsColor)
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pixels[slot] = {numberOfRequests, x, y, 0};
+    return numberOfRequests++;
+}
+
+std::optional<PixelReader::Pixel> PixelReader::poll() {
+    //Requests complete in order, so stop at the first one which is still pending
+    std::optional<Pixel> pixel = std::nullopt;
+    for (uint i = 0; i < ringSize; i++) {
+        const uint slot = (numberOfRequests + i) % ringSize;
+        if (!fences[slot])
+            continue;
+        const GLenum status = glClientWaitSync(fences[slot], 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[slot].getID());
+        glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, sizeof(GLuint), &pixels[slot].value);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glDeleteSync(fences[slot]);
+        fences[slot] = nullptr;
+        pixel = pixels[slot];
+    }
+    return pixel;
+}
+
+}  // namespace lenny::gui
@@ -0,0 +1,167 @@
+#include <glad/glad.h>
+#include <lenny/gui/Model.h>
+#include <lenny/gui/Polyline.h>
+#include <lenny/gui/RenderQueue.h>
+#include <lenny/gui/Renderer.h>
+#include <lenny/gui/Shaders.h>
+#include <lenny/gui/Utils.h>
+
+namespace lenny::gui {
+
+//Uniform handles, resolved once per shader
+static const Shader::Uniform<float> polylineRadiusUniform("polylineRadius");
+static const Shader::Uniform<glm::vec3> objectColorUniform("objectColor");
+static const Shader::Uniform<float> objectAlphaUniform("objectAlpha");
+static const Shader::Uniform<bool> usePrecomputedNormalMatrixUniform("usePrecomputedNormalMatrix");
+static const Shader::Uniform<uint> objectIDUniform("objectID");
+
+//Meshes expanded per segment (unit cylinder along z) and per point (unit sphere)
+inline const Model::Mesh& getSegmentMesh() {
+    static const std::shared_ptr<const Model> model = Renderer::f_createModel(LENNY_GUI_OPENGL_FOLDER "/data/meshes/cylinder.obj");
+    return model->meshes.at(0);
+}
+
+inline const Model::Mesh& getJointMesh() {
+    static const std::shared_ptr<const Model> model = Renderer::f_createModel(LENNY_GUI_OPENGL_FOLDER "/data/meshes/sphere.obj");
+    return model->meshes.at(0);
+}
+
+void Polyline::set(const std::vector<Eigen::Vector3d>& points) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool isEqual = points.size() == this->points.size();
+    for (size_t i = 0; isEqual && i < points.size(); i++)
+        isEqual = utils::toGLM(points[i]) == this->points[i];
+    if (isEqual)
+        return;
+
+    this->points.resize(points.size());
+    for (size_t i = 0; i < points.size(); i++)
+        this->points[i] = utils::toGLM(points[i]);
+    uploadedPoints = 0;
+}
+
+void Polyline::append(const Eigen::Vector3d& point) {
+    std::lock_guard<std::mutex> lock(mutex);
+    points.push_back(utils::toGLM(point));
+}
+
+void Polyline::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    points.clear();
+    uploadedPoints = 0;
+}
+
+void Polyline::removeFront(const size_t& count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    points.erase(points.begin(), points.begin() + std::min(count, points.size()));
+    uploadedPoints = 0;
+}
+
+size_t Polyline::getNumberOfPoints() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return points.size();
+}
+
+void Polyline::draw(const double& radius, const Eigen::Vector4d& color, const bool& showDots) const {
+    const size_t numberOfPoints = upload();
+    if (numberOfPoints == 0)
+        return;
+
+    //Spheres at the points close the gaps between segments, or show up as dots
+    const float tubeRadius = (float)radius;
+    const float jointRadius = showDots ? 2.f * tubeRadius : tubeRadius;
+    const glm::vec4 glmColor((float)color[0], (float)color[1], (float)color[2], (float)color[3]);
+    const uint segmentVariant = Shaders::TUBE | getSegmentMesh().getLayoutVariant();
+    const uint jointVariant = Shaders::JOINT | getJointMesh().getLayoutVariant();
+    auto drawSegments = [this, numberOfPoints, tubeRadius, glmColor]() -> void { drawInstances(Shaders::TUBE, numberOfPoints - 1, tubeRadius, glmColor); };
+    auto drawJoints = [this, numberOfPoints, jointRadius, glmColor]() -> void { drawInstances(Shaders::JOINT, numberOfPoints, jointRadius, glmColor); };
+
+    if (RenderQueue::current) {
+        std::unique_lock<std::mutex> lock(mutex);
+        const glm::vec3 position = points.front();
+        lock.unlock();
+
+        const bool isTransparent = color[3] < 1.0;
+        if (numberOfPoints > 1)
+            RenderQueue::current->addCustom(drawSegments, segmentVariant, position, isTransparent);
+        RenderQueue::current->addCustom(drawJoints, jointVariant, position, isTransparent);
+    } else {
+        if (numberOfPoints > 1) {
+            Shaders::useVariant(segmentVariant);
+            drawSegments();
+        }
+        Shaders::useVariant(jointVariant);
+        drawJoints();
+    }
+}
+
+size_t Polyline::upload() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    //Reallocate (and upload everything again) if the points do not fit anymore
+    if (points.size() > capacity) {
+        capacity = std::max<size_t>(2 * points.size(), 64);
+        pointBuffer = GLBuffer::create();
+        glBindBuffer(GL_ARRAY_BUFFER, pointBuffer.getID());
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        pointBuffer.setBytes(capacity * sizeof(glm::vec3));
+        uploadedPoints = 0;
+        setupVertexArrays();
+    }
+
+    //Only upload points which were added since the last draw
+    if (points.size() > uploadedPoints) {
+        glBindBuffer(GL_ARRAY_BUFFER, pointBuffer.getID());
+        glBufferSubData(GL_ARRAY_BUFFER, uploadedPoints * sizeof(glm::vec3), (points.size() - uploadedPoints) * sizeof(glm::vec3), &points[uploadedPoints]);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        uploadedPoints = points.size();
+    }
+    return points.size();
+}
+
+void Polyline::setupVertexArrays() const {
+    //Segments read two consecutive points per instance ...
+    tubeVAO = GLVertexArray::create();
+    glBindVertexArray(tubeVAO.getID());
+    getSegmentMesh().setupVertexAttributes();
+    glBindBuffer(GL_ARRAY_BUFFER, pointBuffer.getID());
+    for (uint i = 0; i < 2; i++) {
+        glEnableVertexAttribArray(3 + i);
+        glVertexAttribPointer(3 + i, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)(i * sizeof(glm::vec3)));
+        glVertexAttribDivisor(3 + i, 1);
+    }
+
+    //... and joints a single one
+    jointVAO = GLVertexArray::create();
+    glBindVertexArray(jointVAO.getID());
+    getJointMesh().setupVertexAttributes();
+    glBindBuffer(GL_ARRAY_BUFFER, pointBuffer.getID());
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)nullptr);
+    glVertexAttribDivisor(3, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Polyline::drawInstances(const uint& variant, const size_t& count, const float& radius, const glm::vec4& color) const {
+    //Expects the given variant to be active
+    Shaders::activeShader->set(polylineRadiusUniform, radius);
+    Shaders::activeShader->set(objectColorUniform, glm::vec3(color));
+    Shaders::activeShader->set(objectAlphaUniform, color[3]);
+    Shaders::activeShader->set(usePrecomputedNormalMatrixUniform, true);
+    Shaders::activeShader->set(objectIDUniform, 0u);
+
+    const Model::Mesh& mesh = variant == Shaders::TUBE ? getSegmentMesh() : getJointMesh();
+    mesh.setLayoutUniforms();
+    glBindVertexArray(variant == Shaders::TUBE ? tubeVAO.getID() : jointVAO.getID());
+    glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)mesh.getIndices().size(), GL_UNSIGNED_INT, nullptr, (GLsizei)count);
+    glBindVertexArray(0);
+
+    //Update statistics
+    Model::statistics.drawCalls++;
+    Model::statistics.vertices += mesh.getIndices().size() * count;
+}
+
+}  // namespace lenny::gui
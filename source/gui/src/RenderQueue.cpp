@@ -0,0 +1,96 @@
+#include <glad/glad.h>
+#include <lenny/gui/RenderQueue.h>
+#include <lenny/gui/Shaders.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace lenny::gui {
+
+void RenderQueue::begin(const glm::vec3& cameraPosition) {
+    this->cameraPosition = cameraPosition;
+    items.clear();
+    usedInstanceLists = 0;
+}
+
+void RenderQueue::add(const Model::Mesh& mesh, const glm::mat4& pose, const glm::mat3& normalMatrix, const std::optional<Eigen::Vector3d>& color,
+                      const float& alpha, const uint& lod) {
+    Item& item = items.emplace_back();
+    item.mesh = &mesh;
+    item.variant = mesh.getVariant(color);
+    if (!color.has_value() && mesh.getMaterial().has_value())
+        item.texture = mesh.getMaterial()->texture_diffuse ? mesh.getMaterial()->texture_diffuse->getID() : 0;
+    item.isTransparent = alpha < 1.f;
+    item.distance = glm::length(glm::vec3(pose[3]) - cameraPosition);
+    item.pose = pose;
+    item.normalMatrix = normalMatrix;
+    item.color = color;
+    item.alpha = alpha;
+    item.lod = lod;
+    item.objectID = Model::objectID;
+}
+
+void RenderQueue::addInstanced(const Model::Mesh& mesh, const std::vector<Model::Instance>& instances) {
+    if (instances.empty())
+        return;
+    if (usedInstanceLists == instanceLists.size())
+        instanceLists.emplace_back();
+    instanceLists[usedInstanceLists] = instances;
+
+    Item& item = items.emplace_back();
+    item.mesh = &mesh;
+    item.variant = Shaders::INSTANCED | mesh.getLayoutVariant();
+    item.objectID = Model::objectID;
+    item.instanceList = (int)usedInstanceLists++;
+}
+
+void RenderQueue::addCustom(const std::function<void()>& f_draw, const uint& variant, const glm::vec3& position, const bool& isTransparent) {
+    Item& item = items.emplace_back();
+    item.variant = variant;
+    item.isTransparent = isTransparent;
+    item.distance = glm::length(position - cameraPosition);
+    item.f_draw = f_draw;
+}
+
+void RenderQueue::execute() {
+    //Opaque items first, grouped by state and front-to-back within a group (early depth test), then transparent items back-to-front
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) -> bool {
+        if (a.isTransparent != b.isTransparent)
+            return b.isTransparent;
+        if (a.isTransparent)
+            return a.distance > b.distance;
+        if (a.variant != b.variant)
+            return a.variant < b.variant;
+        if (a.texture != b.texture)
+            return a.texture < b.texture;
+        if (a.mesh != b.mesh)
+            return std::less<const Model::Mesh*>()(a.mesh, b.mesh);
+        return a.distance < b.distance;
+    });
+
+    //Opaque pass without blending
+    glDisable(GL_BLEND);
+    bool isBlending = false;
+    for (const Item& item : items) {
+        if (item.isTransparent && !isBlending) {
+            glEnable(GL_BLEND);
+            isBlending = true;
+        }
+
+        Shaders::useVariant(item.variant);
+        if (item.f_draw) {
+            item.f_draw();
+        } else if (item.instanceList >= 0) {
+            item.mesh->drawInstanced(instanceLists[item.instanceList], item.objectID);
+        } else {
+            Model::setUniforms(item.pose, item.normalMatrix, item.alpha, item.objectID);
+            item.mesh->draw(item.color, item.lod);
+        }
+    }
+    if (!isBlending)
+        glEnable(GL_BLEND);
+
+    items.clear();
+}
+
+}  // namespace lenny::gui
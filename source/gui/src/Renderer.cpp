@@ -1,17 +1,324 @@
+#include <glad/glad.h>
+#include <lenny/gui/AssetCache.h>
 #include <lenny/gui/Model.h>
+#include <lenny/gui/RenderQueue.h>
 #include <lenny/gui/Renderer.h>
+#include <lenny/gui/Shaders.h>
 #include <lenny/gui/Utils.h>
+#include <lenny/tools/Logger.h>
 
 namespace lenny::gui {
 
-std::function<std::shared_ptr<gui::Model>(const std::string&)> Renderer::f_createModel = [](const std::string& filePath) {
-    return std::make_shared<gui::Model>(filePath);
+static const Shader::Uniform<float> pointSizeUniform("pointSize");
+
+inline uint toRGBA8(const Eigen::Vector4d& color) {
+    uint packed = 0;
+    for (int i = 0; i < 4; i++)
+        packed |= (uint)std::lround(255.0 * std::clamp(color[i], 0.0, 1.0)) << (8 * i);
+    return packed;
+}
+
+inline glm::vec4 toGLMColor(const Eigen::Vector4d& color) {
+    return glm::vec4(color[0], color[1], color[2], color[3]);
+}
+
+inline glm::mat4 getSphereTransform(const Eigen::Vector3d& center, const double& radius) {
+    glm::mat4 transform(2.f * (float)radius);
+    transform[3] = glm::vec4(utils::toGLM(center), 1.f);
+    return transform;
+}
+
+//Maps the unit axis `axisIndex` of a rotationally symmetric mesh onto `axis` and the remaining unit axes onto perpendiculars of length `radius`
+inline glm::mat4 getAxisTransform(const Eigen::Vector3d& origin, const Eigen::Vector3d& axis, const double& radius, const int& axisIndex) {
+    const Eigen::Vector3d a = axis.normalized();
+    const Eigen::Vector3d helper = fabs(a.x()) < 0.9 ? Eigen::Vector3d::UnitX() : Eigen::Vector3d::UnitY();
+    const Eigen::Vector3d u = helper.cross(a).normalized();
+    const Eigen::Vector3d v = a.cross(u);
+
+    glm::mat4 transform(1.f);
+    transform[(axisIndex + 1) % 3] = glm::vec4(utils::toGLM(radius * u), 0.f);
+    transform[(axisIndex + 2) % 3] = glm::vec4(utils::toGLM(radius * v), 0.f);
+    transform[axisIndex] = glm::vec4(utils::toGLM(axis), 0.f);
+    transform[3] = glm::vec4(utils::toGLM(origin), 1.f);
+    return transform;
+}
+
+//Unit-radius fan in the xz-plane covering the angles [first, last] (with points (sin, 0, cos)), as thick as the former sector mesh
+inline Model::Mesh createSectorMesh(const double& first, const double& last, const int& segments) {
+    static const float halfThickness = 0.5e-3f;
+    const bool isClosed = last - first >= 2.0 * PI - 1e-6;
+    auto getPoint = [&](const double& i) -> glm::vec3 {
+        const double angle = first + (last - first) * i / (double)segments;
+        return glm::vec3((float)sin(angle), 0.f, (float)cos(angle));
+    };
+    const glm::vec3 up(0.f, halfThickness, 0.f);
+
+    std::vector<Model::Mesh::Vertex> vertices;
+    std::vector<uint> indices;
+    auto addQuad = [&](const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, const glm::vec3& normal) -> void {
+        const uint offset = (uint)vertices.size();
+        for (const glm::vec3& p : {p0, p1, p2, p3})
+            vertices.push_back({p, normal, glm::vec2(0.f)});
+        for (const uint index : {0, 1, 2, 0, 2, 3})
+            indices.push_back(offset + index);
+    };
+
+    for (int i = 0; i < segments; i++) {
+        const glm::vec3 p0 = getPoint(i), p1 = getPoint(i + 1);
+
+        //Top and bottom (degenerate quads towards the center)
+        addQuad(up, p0 + up, p1 + up, up, glm::vec3(0.f, 1.f, 0.f));
+        addQuad(-up, p1 - up, p0 - up, -up, glm::vec3(0.f, -1.f, 0.f));
+
+        //Rim
+        addQuad(p0 - up, p1 - up, p1 + up, p0 + up, getPoint(i + 0.5));
+    }
+
+    //Sides
+    if (!isClosed) {
+        const glm::vec3 p0 = getPoint(0), pN = getPoint(segments);
+        addQuad(-up, p0 - up, p0 + up, up, glm::vec3(-p0.z, 0.f, p0.x));
+        addQuad(-up, up, pN + up, pN - up, glm::vec3(pN.z, 0.f, -pN.x));
+    }
+    return Model::Mesh(vertices, indices);
+}
+
+template <typename T>
+inline const T& getBulkEntry(const std::span<const T>& entries, const size_t& index) {
+    return entries[entries.size() == 1 ? 0 : index];
+}
+
+std::function<std::shared_ptr<const gui::Model>(const std::string&)> Renderer::f_createModel = [](const std::string& filePath) {
+    return AssetCache::get(filePath);
 };
 
+void Renderer::flush() {
+    for (Batch& batch : batches)
+        drawBatch(batch);
+
+    //Sectors of limits which are not drawn anymore are released again. Every use resets the count (instances may also have been drawn already or been
+    //recorded into the render queue, which still references the mesh after this flush)
+    for (auto iter = sectorBatches.begin(); iter != sectorBatches.end();) {
+        Batch& batch = iter->second;
+        drawBatch(batch);
+        if (++batch.idleFlushes > 1000)
+            iter = sectorBatches.erase(iter);
+        else
+            iter++;
+    }
+
+    //Recorded tetrahedra and polylines are drawn by now, so their buffers can be reused
+    usedTetrahedra = 0;
+    usedPolylines = 0;
+}
+
+void Renderer::flushDebug() {
+    const size_t numberOfVertices = debugLines.size() + debugPoints.size();
+    if (numberOfVertices == 0)
+        return;
+
+    if (!debugVAO) {
+        debugVAO = GLVertexArray::create();
+        debugVBO = GLBuffer::create();
+        glBindVertexArray(debugVAO.getID());
+        glBindBuffer(GL_ARRAY_BUFFER, debugVBO.getID());
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), (void*)offsetof(DebugVertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DebugVertex), (void*)offsetof(DebugVertex, color));
+    }
+
+    //Upload lines followed by points into a fresh store
+    glBindVertexArray(debugVAO.getID());
+    glBindBuffer(GL_ARRAY_BUFFER, debugVBO.getID());
+    glBufferData(GL_ARRAY_BUFFER, numberOfVertices * sizeof(DebugVertex), nullptr, GL_STREAM_DRAW);
+    debugVBO.setBytes(numberOfVertices * sizeof(DebugVertex));
+    if (!debugLines.empty())
+        glBufferSubData(GL_ARRAY_BUFFER, 0, debugLines.size() * sizeof(DebugVertex), debugLines.data());
+    if (!debugPoints.empty())
+        glBufferSubData(GL_ARRAY_BUFFER, debugLines.size() * sizeof(DebugVertex), debugPoints.size() * sizeof(DebugVertex), debugPoints.data());
+
+    //Draw
+    Shaders::use(Shaders::DEBUG);
+    Shaders::activeShader->set(pointSizeUniform, debugPointSize);
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    if (!debugLines.empty())
+        glDrawArrays(GL_LINES, 0, (GLsizei)debugLines.size());
+    if (!debugPoints.empty())
+        glDrawArrays(GL_POINTS, (GLint)debugLines.size(), (GLsizei)debugPoints.size());
+    glDisable(GL_PROGRAM_POINT_SIZE);
+    glBindVertexArray(0);
+
+    //Update statistics
+    Model::statistics.drawCalls += (uint)!debugLines.empty() + (uint)!debugPoints.empty();
+    Model::statistics.vertices += numberOfVertices;
+
+    debugLines.clear();
+    debugPoints.clear();
+}
+
+void Renderer::drawBatch(const PRIMITIVE& primitive) {
+    drawBatch(getBatch(primitive));
+}
+
+void Renderer::drawBatch(Batch& batch) {
+    batch.model->drawInstanced(batch.instances);
+    batch.instances.clear();
+}
+
+const Polyline& Renderer::getPolyline(const std::vector<Eigen::Vector3d>& points) {
+    //One per recorded line (like tetrahedra), which keeps the points of static lines resident across frames
+    if (usedPolylines == polylines.size())
+        polylines.push_back(std::make_unique<Polyline>());
+    Polyline& polyline = RenderQueue::current ? *polylines.at(usedPolylines++) : *polylines.at(usedPolylines);
+    polyline.set(points);
+    return polyline;
+}
+
+Renderer::Batch& Renderer::getBatch(const PRIMITIVE& primitive) {
+    if (batches.empty()) {
+        const std::vector<std::string> filePaths = {
+            LENNY_GUI_OPENGL_FOLDER "/data/meshes/cube.obj",     LENNY_GUI_OPENGL_FOLDER "/data/meshes/sphere.obj",
+            LENNY_GUI_OPENGL_FOLDER "/data/meshes/cylinder.obj", LENNY_GUI_OPENGL_FOLDER "/data/meshes/cone.obj",
+        };
+        for (const std::string& filePath : filePaths)
+            batches.push_back({f_createModel(filePath), {}});
+    }
+    return batches.at(primitive);
+}
+
+Renderer::Batch& Renderer::getSectorBatch(const std::pair<double, double>& angleRange) {
+    //Quantize the range, such that static limits always map onto the same mesh
+    static const double quantum = 1e-3;
+    const double range = std::min(angleRange.second - angleRange.first, 2.0 * PI);
+    const int segments = std::max((int)std::ceil(range / sectorResolution), 1);
+    const SectorKey key = {(int)std::round(angleRange.first / quantum), (int)std::round(range / quantum), segments};
+
+    auto iter = sectorBatches.find(key);
+    if (iter == sectorBatches.end()) {
+        const double first = std::get<0>(key) * quantum;
+        const double last = first + std::get<1>(key) * quantum;
+        std::vector<Model::Mesh> meshes;
+        meshes.push_back(createSectorMesh(first, last, segments));  //Moved, such that the GL buffers are only created once
+        iter = sectorBatches.emplace(key, Batch{std::make_shared<gui::Model>("", std::move(meshes)), {}}).first;
+    }
+    iter->second.idleFlushes = 0;
+    return iter->second;
+}
+
+void Renderer::addInstance(const PRIMITIVE& primitive, const glm::mat4& pose, const Eigen::Vector4d& color) {
+    addInstance(getBatch(primitive), pose, color);
+}
+
+void Renderer::addInstance(Batch& batch, const glm::mat4& pose, const Eigen::Vector4d& color) {
+    pushInstance(batch, Model::Instance(pose, toGLMColor(color)));
+    if (!useInstancing)
+        drawBatch(batch);
+}
+
+void Renderer::pushInstance(const PRIMITIVE& primitive, const Model::Instance& instance) {
+    pushInstance(getBatch(primitive), instance);
+}
+
+void Renderer::pushInstance(Batch& batch, const Model::Instance& instance) {
+    //Transparent primitives need to be sorted individually by the render queue
+    if (instance.color[3] < 1.f && RenderQueue::current) {
+        const Eigen::Vector3d color(instance.color[0], instance.color[1], instance.color[2]);
+        for (const Model::Mesh& mesh : batch.model->meshes)
+            RenderQueue::current->add(mesh, instance.pose, instance.normalMatrix, color, instance.color[3]);
+        return;
+    }
+    batch.instances.push_back(instance);
+}
+
+bool Renderer::checkBulkSizes(const std::string& description, const size_t& count, const std::vector<size_t>& sizes) {
+    for (const size_t& size : sizes) {
+        if (size != count && size != 1) {
+            LENNY_LOG_WARNING("%s: Expected %d or 1 entries, but got %d. Nothing is drawn", description.c_str(), (int)count, (int)size)
+            return false;
+        }
+    }
+    return true;
+}
+
+void Renderer::drawSpheres(std::span<const Eigen::Vector3d> centers, std::span<const double> radii, std::span<const Eigen::Vector4d> colors) {
+    if (!checkBulkSizes("drawSpheres", centers.size(), {radii.size(), colors.size()}))
+        return;
+
+    std::vector<Model::Instance>& instances = getBatch(SPHERE).instances;
+    instances.reserve(instances.size() + centers.size());
+    for (size_t i = 0; i < centers.size(); i++)
+        pushInstance(SPHERE, Model::Instance(getSphereTransform(centers[i], getBulkEntry(radii, i)), toGLMColor(getBulkEntry(colors, i))));
+
+    if (!useInstancing)
+        drawBatch(SPHERE);
+}
+
+void Renderer::drawCylinders(std::span<const Eigen::Vector3d> startPositions, std::span<const Eigen::Vector3d> endPositions, std::span<const double> radii,
+                             std::span<const Eigen::Vector4d> colors) {
+    if (!checkBulkSizes("drawCylinders", startPositions.size(), {endPositions.size(), radii.size(), colors.size()}))
+        return;
+
+    std::vector<Model::Instance>& instances = getBatch(CYLINDER).instances;
+    instances.reserve(instances.size() + startPositions.size());
+    for (size_t i = 0; i < startPositions.size(); i++) {
+        const Eigen::Vector3d axis = getBulkEntry(endPositions, i) - startPositions[i];
+        if (axis.norm() < 10e-10)
+            continue;
+        pushInstance(CYLINDER, Model::Instance(getAxisTransform(startPositions[i], axis, getBulkEntry(radii, i), 2), toGLMColor(getBulkEntry(colors, i))));
+    }
+
+    if (!useInstancing)
+        drawBatch(CYLINDER);
+}
+
+void Renderer::drawCapsules(std::span<const Eigen::Vector3d> startPositions, std::span<const Eigen::Vector3d> endPositions, std::span<const double> radii,
+                            std::span<const Eigen::Vector4d> colors) {
+    if (!checkBulkSizes("drawCapsules", startPositions.size(), {endPositions.size(), radii.size(), colors.size()}))
+        return;
+
+    drawCylinders(startPositions, endPositions, radii, colors);
+    drawSpheres(startPositions, radii, colors);
+    drawSpheres(endPositions, radii, colors);
+}
+
+void Renderer::drawArrows(std::span<const Eigen::Vector3d> startPositions, std::span<const Eigen::Vector3d> directions, std::span<const double> radii,
+                          std::span<const Eigen::Vector4d> colors) {
+    if (!checkBulkSizes("drawArrows", startPositions.size(), {directions.size(), radii.size(), colors.size()}))
+        return;
+
+    std::vector<Model::Instance>& cylinders = getBatch(CYLINDER).instances;
+    std::vector<Model::Instance>& cones = getBatch(CONE).instances;
+    cylinders.reserve(cylinders.size() + startPositions.size());
+    cones.reserve(cones.size() + startPositions.size());
+    for (size_t i = 0; i < startPositions.size(); i++) {
+        //Same construction as in `drawArrow`
+        Eigen::Vector3d dir = getBulkEntry(directions, i);
+        for (uint j = 0; j < 3; j++)
+            if (fabs(dir[j]) < 1e-6)
+                dir[j] = 1e-6;
+
+        const double& radius = getBulkEntry(radii, i);
+        const double coneRadius = 1.5 * radius;
+        const Eigen::Vector3d coneDir = dir / dir.norm() * coneRadius * 1.5;
+        const Eigen::Vector3d cylinderEnd = startPositions[i] + dir - coneDir;
+        const glm::vec4 color = toGLMColor(getBulkEntry(colors, i));
+
+        if ((cylinderEnd - startPositions[i]).norm() >= 10e-10)
+            pushInstance(CYLINDER, Model::Instance(getAxisTransform(startPositions[i], cylinderEnd - startPositions[i], radius, 2), color));
+        if (coneDir.norm() >= 10e-10)
+            pushInstance(CONE, Model::Instance(getAxisTransform(cylinderEnd, 1e-3 * coneDir, 1e-3 * coneRadius, 1), color));
+    }
+
+    if (!useInstancing) {
+        drawBatch(CYLINDER);
+        drawBatch(CONE);
+    }
+}
+
 void Renderer::drawCuboid(const Eigen::Vector3d& COM, const Eigen::QuaternionD& orientation, const Eigen::Vector3d& dimensions,
                           const Eigen::Vector4d& color) const {
-    static std::shared_ptr<gui::Model> cube = f_createModel(LENNY_GUI_OPENGL_FOLDER "/data/meshes/cube.obj");
-    cube->draw(COM, orientation, dimensions, color.segment(0, 3), color[3]);
+    addInstance(CUBE, utils::getGLMTransform(COM, orientation, dimensions), color);
 }
 
 void Renderer::drawPlane(const Eigen::Vector3d& COM, const Eigen::QuaternionD& orientation, const Eigen::Vector2d& dimensions,
@@ -20,32 +327,20 @@ void Renderer::drawPlane(const Eigen::Vector3d& COM, const Eigen::QuaternionD& o
 }
 
 void Renderer::drawSphere(const Eigen::Vector3d& position, const double& radius, const Eigen::Vector4d& color) const {
-    static std::shared_ptr<gui::Model> sphere = f_createModel(LENNY_GUI_OPENGL_FOLDER "/data/meshes/sphere.obj");
-    sphere->draw(position, Eigen::QuaternionD::Identity(), 2.0 * radius * Eigen::Vector3d::Ones(), color.segment(0, 3), color[3]);
+    addInstance(SPHERE, getSphereTransform(position, radius), color);
 }
 
 void Renderer::drawEllipsoid(const Eigen::Vector3d& COM, const Eigen::QuaternionD& orientation, const Eigen::Vector3d& dimensions,
                              const Eigen::Vector4d& color) const {
-    static std::shared_ptr<gui::Model> sphere = f_createModel(LENNY_GUI_OPENGL_FOLDER "/data/meshes/sphere.obj");
-    sphere->draw(COM, orientation, 2.0 * dimensions, color.segment(0, 3), color[3]);
+    addInstance(SPHERE, utils::getGLMTransform(COM, orientation, 2.0 * dimensions), color);
 }
 
 void Renderer::drawCylinder(const Eigen::Vector3d& startPosition, const Eigen::Vector3d& endPosition, const double& radius,
                             const Eigen::Vector4d& color) const {
-    static std::shared_ptr<gui::Model> cylinder = f_createModel(LENNY_GUI_OPENGL_FOLDER "/data/meshes/cylinder.obj");
-
-    Eigen::Vector3d dir = endPosition - startPosition;
-    double s = dir.norm();
-    if (s < 10e-10)
+    const Eigen::Vector3d dir = endPosition - startPosition;
+    if (dir.norm() < 10e-10)
         return;
-    Eigen::Vector3d a = dir.normalized();
-    Eigen::Vector3d b = Eigen::Vector3d::UnitZ();
-    Eigen::Vector3d v = (b.cross(a)).normalized();
-    if (v.norm() < 0.5)
-        v = Eigen::Vector3d::UnitX();
-    double angle = acos(b.dot(a) / (b.norm() * a.norm()));
-
-    cylinder->draw(startPosition, Eigen::QuaternionD(Eigen::AngleAxisd(angle, v)), Eigen::Vector3d(radius, radius, s), color.segment(0, 3), color[3]);
+    addInstance(CYLINDER, getAxisTransform(startPosition, dir, radius, 2), color);
 }
 
 void Renderer::drawCylinder(const Eigen::Vector3d& COM, const Eigen::QuaternionD& orientation, const double& height, const double& radius,
@@ -56,18 +351,24 @@ void Renderer::drawCylinder(const Eigen::Vector3d& COM, const Eigen::QuaternionD
 }
 
 void Renderer::drawTetrahedron(const std::array<Eigen::Vector3d, 4>& globalPoints, const Eigen::Vector4d& color) const {
-    //Generate model
-    static std::shared_ptr<gui::Model> tetrahedron = f_createModel(LENNY_GUI_OPENGL_FOLDER "/data/meshes/tetrahedron.obj");
     static const std::vector<uint> indices = {0, 1, 2, 1, 2, 3, 0, 1, 3, 0, 2, 3};
     static std::vector<Model::Mesh::Vertex> vertices(4, Model::Mesh::Vertex());
 
+    //Get model (one per recorded tetrahedron, since the render queue references their meshes until the scene is flushed). They are copies of the
+    //cached one, since their vertices change
+    if (usedTetrahedra == tetrahedra.size()) {
+        tetrahedra.push_back(std::make_shared<gui::Model>(*f_createModel(LENNY_GUI_OPENGL_FOLDER "/data/meshes/tetrahedron.obj")));
+        tetrahedra.back()->meshes.at(0).updateIndices(indices);
+    }
+    const std::shared_ptr<gui::Model>& tetrahedron = RenderQueue::current ? tetrahedra.at(usedTetrahedra++) : tetrahedra.at(usedTetrahedra);
+
     //Update vertices
     static const glm::vec3 normal = utils::toGLM(Eigen::Vector3d::Ones().normalized());
     for (int i = 0; i < 4; i++) {
         vertices.at(i).position = utils::toGLM(globalPoints.at(i));
         vertices.at(i).normal = normal;
     }
-    tetrahedron->meshes.at(0) = Model::Mesh(vertices, indices);
+    tetrahedron->meshes.at(0).updateVertices(vertices);
 
     //Draw model
     static const Eigen::Vector3d position = Eigen::Vector3d::Zero();
@@ -77,19 +378,9 @@ void Renderer::drawTetrahedron(const std::array<Eigen::Vector3d, 4>& globalPoint
 }
 
 void Renderer::drawCone(const Eigen::Vector3d& origin, const Eigen::Vector3d& direction, const double& radius, const Eigen::Vector4d& color) const {
-    static std::shared_ptr<gui::Model> cone = f_createModel(LENNY_GUI_OPENGL_FOLDER "/data/meshes/cone.obj");
-
-    double s = direction.norm();
-    if (s < 10e-10)
+    if (direction.norm() < 10e-10)
         return;
-    Eigen::Vector3d a = direction.normalized();
-    Eigen::Vector3d b = Eigen::Vector3d::UnitY();
-    Eigen::Vector3d v = (b.cross(a)).normalized();
-    if (v.norm() < 0.5)
-        v = Eigen::Vector3d::UnitX();
-    double angle = acos(b.dot(a) / (b.norm() * a.norm()));
-
-    cone->draw(origin, Eigen::QuaternionD(Eigen::AngleAxisd(angle, v)), 1e-3 * Eigen::Vector3d(radius, s, radius), color.segment(0, 3), color[3]);
+    addInstance(CONE, getAxisTransform(origin, 1e-3 * direction, 1e-3 * radius, 1), color);
 }
 
 void Renderer::drawArrow(const Eigen::Vector3d& startPosition, const Eigen::Vector3d& direction, const double& radius, const Eigen::Vector4d& color) const {
@@ -127,27 +418,23 @@ void Renderer::drawCapsule(const Eigen::Vector3d& COM, const Eigen::QuaternionD&
 }
 
 void Renderer::drawLine(const std::vector<Eigen::Vector3d>& linePoints, const double& radius, const Eigen::Vector4d& color) const {
-    for (uint i = 0; i < linePoints.size() - 1; i++)
-        drawCylinder(linePoints[i], linePoints[i + 1], radius, color);
+    if (linePoints.size() < 2)
+        return;
+    getPolyline(linePoints).draw(radius, color, false);
 }
 
 void Renderer::drawTrajectory(const std::vector<Eigen::Vector3d>& trajectoryPoints, const double& radius, const Eigen::Vector4d& color,
                               const bool& showDots) const {
-    drawLine(trajectoryPoints, radius, color);
-    if (showDots) {
-        const double dotRadius = 2.0 * radius;
-        for (uint i = 0; i < trajectoryPoints.size(); i++)
-            drawSphere(trajectoryPoints[i], dotRadius, color);
-    }
+    if (trajectoryPoints.empty())
+        return;
+    getPolyline(trajectoryPoints).draw(radius, color, showDots);
 }
 
 void Renderer::drawSector(const Eigen::Vector3d& center, const Eigen::QuaternionD& orientation, const double& radius,
                           const std::pair<double, double>& angleRange, const Eigen::Vector4d& color) const {
-    static std::shared_ptr<gui::Model> sector = f_createModel(LENNY_GUI_OPENGL_FOLDER "/data/meshes/sector.obj");
-    for (double angle = angleRange.first; angle < angleRange.second; angle += PI / 180.0) {
-        sector->draw(center, orientation * tools::utils::getRotationQuaternion(angle, Eigen::Vector3d::UnitY()), 1e-3 * radius * Eigen::Vector3d::Ones(),
-                     color.segment(0, 3), color[3]);
-    }
+    if (angleRange.second <= angleRange.first || radius <= 0.0)
+        return;
+    addInstance(getSectorBatch(angleRange), utils::getGLMTransform(center, orientation, radius * Eigen::Vector3d::Ones()), color);
 }
 
 void Renderer::drawRoundedCuboid(const Eigen::Vector3d& COM, const Eigen::QuaternionD& orientation, const Eigen::Vector3d& dimensions, const double& radius,
@@ -210,4 +497,35 @@ void Renderer::drawRoundedPlane(const Eigen::Vector3d& COM, const Eigen::Quatern
               color);
 }
 
+void Renderer::drawDebugLine(const Eigen::Vector3d& startPosition, const Eigen::Vector3d& endPosition, const Eigen::Vector4d& color) {
+    const uint packedColor = toRGBA8(color);
+    debugLines.push_back({utils::toGLM(startPosition), packedColor});
+    debugLines.push_back({utils::toGLM(endPosition), packedColor});
+}
+
+void Renderer::drawDebugPoint(const Eigen::Vector3d& position, const Eigen::Vector4d& color) {
+    debugPoints.push_back({utils::toGLM(position), toRGBA8(color)});
+}
+
+void Renderer::drawDebugBox(const Eigen::Vector3d& COM, const Eigen::QuaternionD& orientation, const Eigen::Vector3d& dimensions,
+                            const Eigen::Vector4d& color) {
+    //Corner i has the coordinates (+-x, +-y, +-z) given by bits 0, 1 and 2 of i
+    std::array<glm::vec3, 8> corners;
+    for (int i = 0; i < 8; i++) {
+        const Eigen::Vector3d local(i & 1 ? 0.5 : -0.5, i & 2 ? 0.5 : -0.5, i & 4 ? 0.5 : -0.5);
+        corners[i] = utils::toGLM(COM + orientation * local.cwiseProduct(dimensions));
+    }
+
+    //Edges connect corners which differ in a single bit
+    const uint packedColor = toRGBA8(color);
+    for (int i = 0; i < 8; i++) {
+        for (int bit = 1; bit < 8; bit <<= 1) {
+            if (i & bit)
+                continue;
+            debugLines.push_back({corners[i], packedColor});
+            debugLines.push_back({corners[i | bit], packedColor});
+        }
+    }
+}
+
 }  // namespace lenny::gui
\ No newline at end of file
@@ -20,40 +20,55 @@
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
 #include <stb_image_resize.h>
 
+#include <bit>
+
 namespace lenny::gui {
 
-Scene::Scene(const std::string& description, const int& width, const int& height) : description(description), textureWidth(width), textureHeight(height) {
+Scene::Scene(const std::string& description, const int& width, const int& height)
+    : description(description),
+      idReader(GL_RED_INTEGER, GL_UNSIGNED_INT, GL_COLOR_ATTACHMENT1),
+      depthReader(GL_DEPTH_COMPONENT, GL_FLOAT, GL_NONE),
+      textureWidth(width),
+      textureHeight(height) {
     //Framebuffer
-    glGenFramebuffers(1, &frameBuffer);
+    frameBuffer = GLFramebuffer::create();
 
     //Texture
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    texture = GLTexture::create();
+    glBindTexture(GL_TEXTURE_2D, texture.getID());
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    texture.setBytes((size_t)width * height * 4);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     //Renderbuffer
-    glGenRenderbuffers(1, &renderBuffer);
-    glBindRenderbuffer(GL_RENDERBUFFER, renderBuffer);
+    renderBuffer = GLRenderbuffer::create();
+    glBindRenderbuffer(GL_RENDERBUFFER, renderBuffer.getID());
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    renderBuffer.setBytes((size_t)width * height * 4);
+
+    //Object IDs
+    idTexture = GLTexture::create();
+    glBindTexture(GL_TEXTURE_2D, idTexture.getID());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);
+    idTexture.setBytes((size_t)width * height * 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    //Camera and light uniform buffer
+    sceneBuffer = Shaders::generateSceneBuffer();
 
     //Attach texture and renderbuffer to framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer.getID());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.getID(), 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, idTexture.getID(), 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderBuffer.getID());
 
     //Always check that our framebuffer is ok
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         LENNY_LOG_ERROR("Something went wrong when initializing a frame buffer")
 }
 
-Scene::~Scene() {
-    glDeleteFramebuffers(1, &frameBuffer);
-    glDeleteTextures(1, &texture);
-    glDeleteRenderbuffers(1, &renderBuffer);
-}
-
 void Scene::draw() {
     //Begin ImGui window
     ImGui::Begin(description.c_str(), nullptr, ImGuiWindowFlags_NoScrollWithMouse | ImGuiWindowFlags_NoScrollbar);
@@ -69,14 +84,40 @@ void Scene::draw() {
     //Update camera parameters
     camera.setAspectRatio(size.x / size.y);
 
-    //Update shader
-    Shaders::update(camera, light);
+    //Update and bind camera and light data
+    Shaders::update(sceneBuffer, sceneData, camera, light);
 
     //Prepare frame buffer
-    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer.getID());
     glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
+    //Write object IDs into the second attachment (integer attachments need to be cleared separately)
+    if (usePicking) {
+        const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+        glDrawBuffers(2, drawBuffers);
+        const GLuint noObject[] = {0, 0, 0, 0};
+        glClearBufferuiv(GL_COLOR, 1, noObject);
+    }
+    Model::objectID = 0;
+
+    //Skip meshes and instances outside of the camera frustum
+    const glm::mat4 viewProjection = camera.getProjectionMatrix() * camera.getViewMatrix();
+    frustum = Frustum(viewProjection);
+    if (Frustum::enabled)
+        Frustum::current = &frustum;
+
+    //Select levels of detail based on the projected size in this scene
+    view = {camera.getPosition(), 0.5f * camera.getProjectionMatrix()[1][1] * size.y};
+    Model::view = &view;
+
+    //Record draws into the render queue
+    if (RenderQueue::enabled) {
+        renderQueue.begin(camera.getPosition());
+        RenderQueue::current = &renderQueue;
+    }
+
     //Setup default drawings
     if (showGround)
         ground.drawScene();
@@ -87,11 +128,60 @@ void Scene::draw() {
     if (f_drawScene)
         f_drawScene();
 
+    //Draw batched primitives
+    Model::objectID = 0;
+    Renderer::flush();
+    Frustum::current = nullptr;
+    Model::view = nullptr;
+
+    //Draw recorded items in sorted order
+    if (RenderQueue::current) {
+        RenderQueue::current = nullptr;
+        renderQueue.execute();
+    }
+
+    //Read back what is under the cursor (before debug drawings). Results arrive in a later frame, so the GPU is never waited for
+    const int x = (int)((mousePos[0] - windowPos[0]) / windowSize[0] * textureWidth);
+    const int y = textureHeight - 1 - (int)((mousePos[1] - windowPos[1]) / windowSize[1] * textureHeight);
+    const bool cursorIsInside = x >= 0 && x < textureWidth && y >= 0 && y < textureHeight;
+
+    if (const std::optional<PixelReader::Pixel> pixel = depthReader.poll()) {
+        //Unproject with the matrices of the frame the depth was rendered with
+        const float depth = std::bit_cast<float>(pixel->value);
+        if (depth < 1.f) {
+            const glm::vec4 ndc(2.f * ((float)pixel->x + 0.5f) / (float)textureWidth - 1.f, 2.f * ((float)pixel->y + 0.5f) / (float)textureHeight - 1.f,
+                                2.f * depth - 1.f, 1.f);
+            glm::vec4 point = depthTransforms[pixel->request % PixelReader::ringSize] * ndc;
+            point = point / point[3];
+            cursorPoint = Eigen::Vector3d(point[0], point[1], point[2]);
+        } else {
+            cursorPoint = std::nullopt;
+        }
+    }
+    if (usePicking) {
+        if (const std::optional<PixelReader::Pixel> pixel = idReader.poll())
+            hoveredID = pixel->value;
+    }
+
+    if (cursorIsInside) {
+        const uint request = depthReader.request(x, y);
+        depthTransforms[request % PixelReader::ringSize] = glm::inverse(viewProjection);
+        if (usePicking)
+            idReader.request(x, y);
+    } else {
+        cursorPoint = std::nullopt;
+    }
+    if (!cursorIsInside || !usePicking)
+        hoveredID = 0;
+
+    //Draw debug lines and points (depth tested against everything else)
+    Renderer::flushDebug();
+
     //Unbind frame buffer
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     //Draw texture
-    ImGui::Image((ImTextureID)texture, size, ImVec2(0, 1), ImVec2(1, 0));
+    ImGui::Image((ImTextureID)texture.getID(), size, ImVec2(0, 1), ImVec2(1, 0));
 
     //Update parameters
     if (ImGui::IsWindowHovered())
@@ -107,11 +197,19 @@ void Scene::draw() {
 void Scene::drawGui() {
     ImGui::Checkbox("Show Ground", &showGround);
     ImGui::Checkbox("Show Origin", &showOrigin);
+    ImGui::Checkbox("ID Buffer Picking", &usePicking);
 
     camera.drawGui();
     light.drawGui();
     ground.drawGui();
 
+    if (ImGui::TreeNode("Culling")) {
+        ImGui::Checkbox("Frustum Culling", &Frustum::enabled);
+        ImGui::Text("Visible: %llu", frustum.statistics.visible);
+        ImGui::Text("Culled: %llu", frustum.statistics.culled);
+        ImGui::TreePop();
+    }
+
     if(ImGui::Button("Save Screenshot"))
         saveScreenshotToFile(LENNY_PROJECT_FOLDER"/logs/Screenshot-" + description + "-" + tools::utils::getCurrentDateAndTime() + ".png");
 }
@@ -122,12 +220,19 @@ void Scene::resizeWindowCallback(int width, int height) {
     this->textureHeight = height;
 
     //Update texture
-    glBindTexture(GL_TEXTURE_2D, texture);
+    glBindTexture(GL_TEXTURE_2D, texture.getID());
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    texture.setBytes((size_t)width * height * 4);
 
     //Update renderbuffer
-    glBindRenderbuffer(GL_RENDERBUFFER, renderBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderBuffer.getID());
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    renderBuffer.setBytes((size_t)width * height * 4);
+
+    //Update object IDs
+    glBindTexture(GL_TEXTURE_2D, idTexture.getID());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);
+    idTexture.setBytes((size_t)width * height * 4);
 }
 
 void Scene::keyboardKeyCallback(int key, int action) {
@@ -147,6 +252,7 @@ void Scene::mouseButtonCallback(double xPos, double yPos, Ray ray, int button, i
 }
 
 void Scene::mouseMoveCallback(double xPos, double yPos, Ray ray) {
+    mousePos = {xPos, yPos};
     if (blockCallbacks)
         return;
 
@@ -190,11 +296,20 @@ void Scene::sync(const Scene::CSPtr otherScene) {
     this->clearColor = otherScene->clearColor;
     this->showGround = otherScene->showGround;
     this->showOrigin = otherScene->showOrigin;
+    this->usePicking = otherScene->usePicking;
+}
+
+uint Scene::getHoveredID() const {
+    return hoveredID;
+}
+
+std::optional<Eigen::Vector3d> Scene::getCursorPoint() const {
+    return cursorPoint;
 }
 
 bool Scene::saveScreenshotToFile(const std::string& filePath) const {
     //Bind frame buffer
-    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer.getID());
     const GLsizei nrChannels = 3;
 
     //Get image
@@ -2,74 +2,154 @@
 #include <lenny/gui/Shader.h>
 #include <lenny/tools/Logger.h>
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
-#include <vector>
 
 namespace lenny::gui {
 
-Shader::Shader(const std::string &vertexPath, const std::string &fragmentPath) {
-    load(vertexPath, fragmentPath);
+Shader::Statistics Shader::statistics = {};
+
+Shader::Shader(const std::string &vertexPath, const std::string &fragmentPath, const std::vector<std::string> &defines) {
+    load(vertexPath, fragmentPath, defines);
 }
 
 void Shader::activate() const {
-    glUseProgram(ID);
+    glUseProgram(program.getID());
+    statistics.programSwitches++;
+}
+
+template <>
+void Shader::set(const Uniform<bool> &uniform, const bool &value) const {
+    glUniform1i(getUniformLocation(uniform.id), (int)value);
+}
+
+template <>
+void Shader::set(const Uniform<int> &uniform, const int &value) const {
+    glUniform1i(getUniformLocation(uniform.id), value);
+}
+
+template <>
+void Shader::set(const Uniform<uint> &uniform, const uint &value) const {
+    glUniform1ui(getUniformLocation(uniform.id), value);
+}
+
+template <>
+void Shader::set(const Uniform<float> &uniform, const float &value) const {
+    glUniform1f(getUniformLocation(uniform.id), value);
+}
+
+template <>
+void Shader::set(const Uniform<glm::vec2> &uniform, const glm::vec2 &value) const {
+    glUniform2fv(getUniformLocation(uniform.id), 1, &value[0]);
+}
+
+template <>
+void Shader::set(const Uniform<glm::vec3> &uniform, const glm::vec3 &value) const {
+    glUniform3fv(getUniformLocation(uniform.id), 1, &value[0]);
+}
+
+template <>
+void Shader::set(const Uniform<glm::vec4> &uniform, const glm::vec4 &value) const {
+    glUniform4fv(getUniformLocation(uniform.id), 1, &value[0]);
+}
+
+template <>
+void Shader::set(const Uniform<glm::mat3> &uniform, const glm::mat3 &value) const {
+    glUniformMatrix3fv(getUniformLocation(uniform.id), 1, GL_FALSE, &value[0][0]);
+}
+
+template <>
+void Shader::set(const Uniform<glm::mat4> &uniform, const glm::mat4 &value) const {
+    glUniformMatrix4fv(getUniformLocation(uniform.id), 1, GL_FALSE, &value[0][0]);
 }
 
 void Shader::setBool(const std::string &name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    glUniform1i(getUniformLocation(name), (int)value);
 }
 
 void Shader::setInt(const std::string &name, int value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string &name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setVec2(const std::string &name, const glm::vec2 &value) const {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform2fv(getUniformLocation(name), 1, &value[0]);
 }
 void Shader::setVec2(const std::string &name, float x, float y) const {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+    glUniform2f(getUniformLocation(name), x, y);
 }
 
 void Shader::setVec3(const std::string &name, const glm::vec3 &value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform3fv(getUniformLocation(name), 1, &value[0]);
 }
 void Shader::setVec3(const std::string &name, float x, float y, float z) const {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    glUniform3f(getUniformLocation(name), x, y, z);
 }
 
 void Shader::setVec4(const std::string &name, const glm::vec4 &value) const {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform4fv(getUniformLocation(name), 1, &value[0]);
 }
 void Shader::setVec4(const std::string &name, float x, float y, float z, float w) const {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+    glUniform4f(getUniformLocation(name), x, y, z, w);
 }
 
 void Shader::setMat2(const std::string &name, const glm::mat2 &mat) const {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setMat3(const std::string &name, const glm::mat3 &mat) const {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 unsigned int Shader::getID() const {
-    return ID;
+    return program.getID();
+}
+
+int Shader::getUniformLocation(const std::string &name) const {
+    statistics.nameLookups++;
+    const auto iter = std::lower_bound(uniformTable.begin(), uniformTable.end(), name,
+                                       [](const UniformInfo &info, const std::string &name) -> bool { return info.name < name; });
+    if (iter == uniformTable.end() || iter->name != name)
+        return -1;  //Inactive uniform, which OpenGL silently ignores
+    return iter->location;
+}
+
+int Shader::getUniformLocation(const unsigned int &id) const {
+    if (id >= locationsByHandle.size())
+        locationsByHandle.resize(getUniformNames().size(), -2);
+    int &location = locationsByHandle[id];
+    if (location == -2)  //Not resolved yet
+        location = getUniformLocation(getUniformNames()[id]);
+    return location;
+}
+
+unsigned int Shader::registerUniformName(const std::string &name) {
+    std::vector<std::string> &names = getUniformNames();
+    const auto iter = std::find(names.begin(), names.end(), name);
+    if (iter != names.end())
+        return (unsigned int)(iter - names.begin());
+    names.emplace_back(name);
+    return (unsigned int)names.size() - 1;
+}
+
+std::vector<std::string> &Shader::getUniformNames() {
+    static std::vector<std::string> names;  //Function-local, so handles can be created during static initialization
+    return names;
 }
 
-void Shader::load(const std::string &vertexPath, const std::string &fragmentPath) {
+void Shader::load(const std::string &vertexPath, const std::string &fragmentPath, const std::vector<std::string> &defines) {
     //--- Retrieve the vertex/fragment source code from the individual files
     std::string vertexCode, fragmentCode;
-    getCodeFromFile(vertexCode, vertexPath);
-    getCodeFromFile(fragmentCode, fragmentPath);
+    getCodeFromFile(vertexCode, vertexPath, defines);
+    getCodeFromFile(fragmentCode, fragmentPath, defines);
     const char *vCode = vertexCode.c_str();
     const char *fCode = fragmentCode.c_str();
 
@@ -89,7 +169,8 @@ void Shader::load(const std::string &vertexPath, const std::string &fragmentPath
     checkShaderCompilationErrors(fragment, "FRAGMENT");
 
     //--- Link program
-    ID = glCreateProgram();
+    program = GLProgram::create();
+    const unsigned int ID = program.getID();
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
     glLinkProgram(ID);
@@ -98,9 +179,42 @@ void Shader::load(const std::string &vertexPath, const std::string &fragmentPath
     // --- Delete shaders
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    //--- Gather uniforms
+    reflectUniforms();
 }
 
-void Shader::getCodeFromFile(std::string &code, const std::string &path) const {
+void Shader::reflectUniforms() {
+    uniformTable.clear();
+    locationsByHandle.clear();
+    const unsigned int ID = program.getID();
+
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<GLchar> buffer(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, (GLuint)i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+
+        //Arrays are reported as `name[0]`, but are addressed by `name` as well
+        std::string name(buffer.data(), length);
+        const GLint location = glGetUniformLocation(ID, name.c_str());
+        statistics.driverLookups++;
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            name.erase(name.size() - 3);
+
+        //Uniforms inside of uniform blocks have no location
+        if (location >= 0)
+            uniformTable.push_back({name, location});
+    }
+    std::sort(uniformTable.begin(), uniformTable.end(), [](const UniformInfo &a, const UniformInfo &b) -> bool { return a.name < b.name; });
+}
+
+void Shader::getCodeFromFile(std::string &code, const std::string &path, const std::vector<std::string> &defines) const {
     //Implement split function
     auto split = [](std::vector<std::string> &v, const std::string &s, const char delim) -> void {
         v.clear();
@@ -128,11 +242,16 @@ void Shader::getCodeFromFile(std::string &code, const std::string &path) const {
         split(token, s, ' ');
         if (token.size() >= 2 && token[0] == "#include") {
             token[1].erase(remove(token[1].begin(), token[1].end(), '\"'), token[1].end());
-            std::string includePath = LENNY_GUI_OPENGL_FOLDER + std::string("/shaders/") + token[1];
+            std::string includePath = LENNY_GUI_OPENGL_FOLDER + std::string("/data/shaders/") + token[1];
             std::ifstream sourceFile(includePath);
             s.assign((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
         }
         stream << s << std::endl;
+
+        //Defines need to follow the version directive
+        if (token.size() >= 1 && token[0] == "#version")
+            for (const std::string &define : defines)
+                stream << "#define " << define << std::endl;
     }
 
     //Close file handlers
@@ -1,35 +1,108 @@
+#include <glad/glad.h>
 #include <lenny/gui/Shaders.h>
+#include <lenny/tools/Logger.h>
+
+#include <cstring>
 
 namespace lenny::gui {
 
-std::vector<Shader> Shaders::shaderList = {};
+std::vector<std::pair<std::string, std::string>> Shaders::shaderFiles = {};
+std::map<std::pair<Shaders::SHADERS, uint>, Shader> Shaders::variants = {};
 
 Shader* Shaders::activeShader = nullptr;
+Shaders::SHADERS Shaders::activeType = Shaders::BASIC;
+bool Shaders::activeShaderIsBound = false;
+
+static_assert(sizeof(Shaders::SceneData) == 2 * 64 + 5 * 16, "SceneData does not match the std140 layout of the SceneData uniform block");
 
 void Shaders::initialize() {
-    shaderList.clear();
-    shaderList.emplace_back(LENNY_GUI_OPENGL_FOLDER "/data/shaders/shader.vert", LENNY_GUI_OPENGL_FOLDER "/data/shaders/shader.frag");
+    shaderFiles.clear();
+    variants.clear();
+    shaderFiles.emplace_back(LENNY_GUI_OPENGL_FOLDER "/data/shaders/shader.vert", LENNY_GUI_OPENGL_FOLDER "/data/shaders/shader.frag");
+    shaderFiles.emplace_back(LENNY_GUI_OPENGL_FOLDER "/data/shaders/debug.vert", LENNY_GUI_OPENGL_FOLDER "/data/shaders/debug.frag");
 
     setActiveShader(BASIC);
 }
 
-void Shaders::update(const Camera& camera, const Light& light) {
-    shaderList[BASIC].activate();
+GLBuffer Shaders::generateSceneBuffer() {
+    GLBuffer sceneBuffer = GLBuffer::create();
+    glBindBuffer(GL_UNIFORM_BUFFER, sceneBuffer.getID());
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(SceneData), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    sceneBuffer.setBytes(sizeof(SceneData));
+    return sceneBuffer;
+}
+
+void Shaders::update(const GLBuffer& sceneBuffer, SceneData& sceneData, const Camera& camera, const Light& light) {
+    SceneData newSceneData;
+    newSceneData.cameraProjection = camera.getProjectionMatrix();
+    newSceneData.cameraView = camera.getViewMatrix();
+    newSceneData.cameraPosition = glm::vec4(camera.getPosition(), 1.f);
+    newSceneData.lightPosition = glm::vec4(light.getPosition(), 1.f);
+    newSceneData.lightColor = glm::vec4(light.getColor(), 1.f);
+    newSceneData.lightGlow = glm::vec4(light.getGlow(), 1.f);
+    newSceneData.lightStrength = glm::vec4(light.ambientStrength, light.diffuseStrength, light.specularStrength, 0.f);
 
-    shaderList[BASIC].setMat4("cameraProjection", camera.getProjectionMatrix());
-    shaderList[BASIC].setMat4("cameraView", camera.getViewMatrix());
-    shaderList[BASIC].setVec3("cameraPosition", camera.getPosition());
+    //Only upload if something changed since the last frame of this scene
+    glBindBuffer(GL_UNIFORM_BUFFER, sceneBuffer.getID());
+    if (std::memcmp(&newSceneData, &sceneData, sizeof(SceneData)) != 0) {
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(SceneData), &newSceneData);
+        sceneData = newSceneData;
+    }
+    glBindBufferBase(GL_UNIFORM_BUFFER, sceneDataBinding, sceneBuffer.getID());
 
-    shaderList[BASIC].setVec3("lightPosition", light.getPosition());
-    shaderList[BASIC].setVec3("lightColor", light.getColor());
-    shaderList[BASIC].setVec3("lightGlow", light.getGlow());
-    shaderList[BASIC].setFloat("strength.ambient", light.ambientStrength);
-    shaderList[BASIC].setFloat("strength.diffuse", light.diffuseStrength);
-    shaderList[BASIC].setFloat("strength.specular", light.specularStrength);
+    //Programs might have been switched outside of this class (e.g. by ImGui) since the last scene
+    activeShaderIsBound = false;
 }
 
 void Shaders::setActiveShader(SHADERS shader) {
-    activeShader = &shaderList[shader];
+    activeType = shader;
+    activeShader = getVariant(shader, COLOR);
+    activeShaderIsBound = false;
+}
+
+void Shaders::useVariant(const uint& variant) {
+    use(activeType, variant);
+}
+
+void Shaders::use(SHADERS type, const uint& variant) {
+    Shader* shader = getVariant(type, variant);
+    if (shader == activeShader && activeShaderIsBound)
+        return;
+    activeShader = shader;
+    activeShader->activate();
+    activeShaderIsBound = true;
+}
+
+uint Shaders::getNumberOfCompiledVariants() {
+    return (uint)variants.size();
+}
+
+Shader* Shaders::getVariant(SHADERS shader, const uint& variant) {
+    auto iter = variants.find({shader, variant});
+    if (iter != variants.end())
+        return &iter->second;
+
+    std::vector<std::string> defines;
+    if (variant & MATERIAL)
+        defines.emplace_back("MATERIAL");
+    if (variant & TEXTURE)
+        defines.emplace_back("TEXTURE");
+    if (variant & WORLD_TEXCOORDS)
+        defines.emplace_back("WORLD_TEXCOORDS");
+    if (variant & INSTANCED)
+        defines.emplace_back("INSTANCED");
+    if (variant & TUBE)
+        defines.emplace_back("TUBE");
+    if (variant & JOINT)
+        defines.emplace_back("JOINT");
+    if (variant & PACKED)
+        defines.emplace_back("PACKED");
+
+    const auto& [vertexPath, fragmentPath] = shaderFiles[shader];
+    iter = variants.try_emplace({shader, variant}, vertexPath, fragmentPath, defines).first;
+    LENNY_LOG_DEBUG("Compiled variant %d of shader %d", (int)variant, (int)shader)
+    return &iter->second;
 }
 
-}  // namespace lenny::gui
\ No newline at end of file
+}  // namespace lenny::gui
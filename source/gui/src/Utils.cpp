@@ -1,6 +1,9 @@
 #include <lenny/gui/Utils.h>
 
+#include <algorithm>
 #include <glm/gtc/type_ptr.hpp>
+#include <thread>
+#include <vector>
 
 namespace lenny::gui::utils {
 
@@ -28,4 +31,27 @@ glm::mat4 getGLMTransform(const Eigen::Vector3d& position, const Eigen::Quaterni
     return transform;
 }
 
+glm::mat3 getGLMNormalMatrix(const glm::mat4& transform) {
+    //Inverse transpose of the upper 3x3 block, such that normals stay orthogonal to surfaces under non-uniform scaling
+    return glm::transpose(glm::inverse(glm::mat3(transform)));
+}
+
+void parallelFor(const size_t& count, const std::function<void(size_t, size_t)>& f_range, const size_t& minimumRangeSize) {
+    const size_t numberOfThreads = std::clamp<size_t>(count / std::max<size_t>(minimumRangeSize, 1), 1, std::max(std::thread::hardware_concurrency(), 1u));
+    if (numberOfThreads == 1) {
+        f_range(0, count);
+        return;
+    }
+
+    //The calling thread takes the first range
+    const size_t rangeSize = (count + numberOfThreads - 1) / numberOfThreads;
+    std::vector<std::thread> threads;
+    threads.reserve(numberOfThreads - 1);
+    for (size_t begin = rangeSize; begin < count; begin += rangeSize)
+        threads.emplace_back(f_range, begin, std::min(begin + rangeSize, count));
+    f_range(0, std::min(rangeSize, count));
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
 }  // namespace lenny::gui::utils
\ No newline at end of file